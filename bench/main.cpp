@@ -0,0 +1,1154 @@
+/***************************************************************************************************
+ * @file  main.cpp
+ * @brief Contains the benchmark program of the project
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Camera.hpp"
+#include "Hit.hpp"
+#include "Image.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "cache/MeshCache.hpp"
+#include "maths/geometry.hpp"
+#include "loaders/PlyFile.hpp"
+#include "loaders/obj.hpp"
+#include "loaders/parsing.hpp"
+#include "loaders/scene.hpp"
+#include "maths/mat4.hpp"
+#include "primitives/InstanceSet.hpp"
+#include "primitives/SphereSet.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @struct Benchmark
+ * @brief A canonical scene rendered at a fixed resolution and sample count.
+ */
+struct Benchmark {
+    const char* name;
+    Scene scene;
+};
+
+/**
+ * @brief Gives the peak resident set size of the process.
+ * @return The peak resident set size in bytes.
+ */
+long long get_peak_rss() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024ll;
+}
+
+/**
+ * @brief Creates a scene with spheres randomly placed in front of the camera.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param samples The number of samples per pixel.
+ * @param sphere_count The number of spheres.
+ * @return The scene.
+ */
+Scene create_spheres_scene(unsigned int width, unsigned int height, unsigned int samples, unsigned int sphere_count) {
+    Camera camera(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f), 90.0f, width, height);
+    Scene scene(width, height, samples, camera);
+
+    std::mt19937 generator(sphere_count);
+    std::uniform_real_distribution<float> position(-4.0f, 4.0f);
+    std::uniform_real_distribution<float> radius(0.05f, 0.3f);
+
+    for(unsigned int i = 0 ; i < sphere_count ; ++i) {
+        scene.spheres.add(vec3(position(generator), position(generator), position(generator) - 6.0f), radius(generator));
+    }
+    scene.spheres.build_bvh();
+
+    return scene;
+}
+
+/**
+ * @brief Creates a UV sphere as an indexed triangle mesh.
+ * @param center The center of the sphere.
+ * @param radius The radius of the sphere.
+ * @param rings The number of rings from pole to pole.
+ * @param segments The number of segments around the poles.
+ * @return The mesh.
+ */
+TriangleMesh create_uv_sphere(const vec3& center, float radius, unsigned int rings, unsigned int segments) {
+    std::vector<vec3> positions;
+    std::vector<std::uint32_t> indices;
+
+    for(unsigned int ring = 0 ; ring <= rings ; ++ring) {
+        float theta = std::numbers::pi_v<float> * ring / rings;
+
+        for(unsigned int segment = 0 ; segment <= segments ; ++segment) {
+            float phi = 2.0f * std::numbers::pi_v<float> * segment / segments;
+            positions.push_back(center + radius * vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                                       std::sin(theta) * std::sin(phi)));
+        }
+    }
+
+    for(unsigned int ring = 0 ; ring < rings ; ++ring) {
+        for(unsigned int segment = 0 ; segment < segments ; ++segment) {
+            std::uint32_t first = ring * (segments + 1) + segment;
+            std::uint32_t second = first + segments + 1;
+
+            indices.insert(indices.end(), { first, second, first + 1 });
+            indices.insert(indices.end(), { first + 1, second, second + 1 });
+        }
+    }
+
+    return TriangleMesh(std::move(positions), std::move(indices));
+}
+
+/**
+ * @brief Creates a scene with a tessellated sphere on a ground quad.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param samples The number of samples per pixel.
+ * @param rings The number of rings of the sphere, which has twice as many segments.
+ * @return The scene.
+ */
+Scene create_mesh_scene(unsigned int width, unsigned int height, unsigned int samples, unsigned int rings) {
+    Camera camera(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f), 90.0f, width, height);
+    Scene scene(width, height, samples, camera);
+
+    scene.meshes.push_back(create_uv_sphere(vec3(0.0f, 0.0f, -1.5f), 0.5f, rings, 2 * rings));
+    scene.meshes.emplace_back(
+        std::vector<vec3>{ vec3(-10.0f, -0.5f, 10.0f), vec3(10.0f, -0.5f, 10.0f),
+                           vec3(10.0f, -0.5f, -10.0f), vec3(-10.0f, -0.5f, -10.0f) },
+        std::vector<std::uint32_t>{ 0, 1, 2, 0, 2, 3 }
+    );
+
+    for(TriangleMesh& mesh : scene.meshes) { mesh.build_bvh(); }
+
+    return scene;
+}
+
+/**
+ * @brief Creates a scene with a grid of rotated and scaled instances of a single tessellated sphere.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param samples The number of samples per pixel.
+ * @param side The number of instances along each side of the grid.
+ * @return The scene.
+ */
+Scene create_instances_scene(unsigned int width, unsigned int height, unsigned int samples, unsigned int side) {
+    Camera camera(vec3(0.0f, 2.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f), 90.0f, width, height);
+    Scene scene(width, height, samples, camera);
+
+    std::mt19937 generator(side);
+    std::uniform_real_distribution<float> angle(0.0f, 2.0f * std::numbers::pi_v<float>);
+    std::uniform_real_distribution<float> size(0.2f, 0.45f);
+
+    std::uint32_t mesh = scene.instances.add_mesh(create_uv_sphere(vec3(0.0f), 1.0f, 64, 128));
+    for(unsigned int i = 0 ; i < side ; ++i) {
+        for(unsigned int j = 0 ; j < side ; ++j) {
+            vec3 position(static_cast<float>(i) - 0.5f * side, 0.0f, -1.0f - static_cast<float>(j));
+            vec3 factors(size(generator), size(generator), size(generator));
+            scene.instances.add_instance(mesh, translate(position) * rotate(angle(generator), vec3(1.0f, 1.0f, 0.0f))
+                                               * scale(factors));
+        }
+    }
+    scene.instances.build_bvh();
+
+    return scene;
+}
+
+/**
+ * @brief Times an intersection kernel by casting rays against a set of primitives.
+ * @param name The name of the kernel in the report.
+ * @param intersect The kernel.
+ * @param primitive_count The number of primitives tested by each ray.
+ * @param rays The rays.
+ * @param hits The hit of every ray, as returned by the kernel.
+ * @return The time spent in the kernel in seconds.
+ */
+double time_kernel(const char* name, const std::function<bool(const Ray&, Hit&)>& intersect,
+                   std::size_t primitive_count, const std::vector<Ray>& rays, std::vector<Hit>& hits) {
+    unsigned long long hit_count = 0;
+    hits.assign(rays.size(), Hit());
+
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0 ; i < rays.size() ; ++i) {
+        hit_count += intersect(rays[i], hits[i]);
+    }
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("    {\n");
+    std::printf("      \"name\": \"%s\",\n", name);
+    std::printf("      \"rays\": %zu,\n      \"primitives\": %zu,\n      \"hits\": %llu,\n",
+                rays.size(), primitive_count, hit_count);
+    std::printf("      \"time\": %.6f,\n", time);
+    std::printf("      \"tests_per_second\": %.1f\n", static_cast<double>(rays.size()) * primitive_count / time);
+    std::printf("    }");
+
+    return time;
+}
+
+/**
+ * @brief Counts the rays whose hits differ between two kernels, comparing the distances bit for bit.
+ * @param reference The hits of the reference kernel.
+ * @param hits The hits of the kernel to check.
+ * @return The number of differing hits.
+ */
+std::size_t count_mismatches(const std::vector<Hit>& reference, const std::vector<Hit>& hits) {
+    std::size_t mismatches = 0;
+
+    for(std::size_t i = 0 ; i < hits.size() ; ++i) {
+        bool same_distance = std::bit_cast<std::uint32_t>(reference[i].distance) == std::bit_cast<std::uint32_t>(hits[i].distance);
+        bool same_primitive = reference[i].primitive == hits[i].primitive;
+        mismatches += !(same_distance && same_primitive);
+    }
+
+    return mismatches;
+}
+
+/**
+ * @brief Times the BVH build and traversal of tessellated spheres of growing triangle counts, and
+ * the closest-hit traversal of the binary BVH against the wide one. The Morton build is then timed
+ * against the SAH one, along with the closest-hit traversal of what it gives. The closest hits of
+ * the first rays are checked against a brute force traversal, on the BVHs built in parallel.
+ * @param pool The pool running the parallel builds.
+ * @param rays The rays.
+ */
+void run_bvh_scaling(ThreadPool& pool, const std::vector<Ray>& rays) {
+    const unsigned int ring_counts[]{ 16, 64, 256, 512 };
+    const std::size_t checked_rays = 256;
+
+    std::printf("  \"bvh_scaling\": [\n");
+
+    for(std::size_t r = 0 ; r < std::size(ring_counts) ; ++r) {
+        TriangleMesh mesh = create_uv_sphere(vec3(0.0f, 0.0f, -3.0f), 1.0f, ring_counts[r], 2 * ring_counts[r]);
+
+        auto start = std::chrono::steady_clock::now();
+        mesh.build_bvh();
+        double build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        mesh.build_bvh(pool);
+        double parallel_build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        unsigned long long hits = 0;
+        start = std::chrono::steady_clock::now();
+        for(const Ray& ray : rays) {
+            Hit hit;
+            hits += mesh.trace(ray, hit);
+        }
+        double closest_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for(const Ray& ray : rays) {
+            Hit hit;
+            mesh.get_bvh().intersect(ray, hit, [&mesh](std::uint32_t triangle, const Ray& ray, Hit& hit) {
+                return mesh.intersect(triangle, ray, hit);
+            });
+        }
+        double binary_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        unsigned long long occluded = 0;
+        start = std::chrono::steady_clock::now();
+        for(const Ray& ray : rays) {
+            occluded += mesh.occluded(ray, std::numeric_limits<float>::infinity());
+        }
+        double any_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        auto count_mesh_mismatches = [&] {
+            std::size_t mismatches = 0;
+            for(std::size_t i = 0 ; i < std::min(checked_rays, rays.size()) ; ++i) {
+                Hit reference;
+                Hit hit;
+                mesh.intersect(rays[i], reference);
+                mesh.trace(rays[i], hit);
+                mismatches += std::bit_cast<std::uint32_t>(reference.distance) != std::bit_cast<std::uint32_t>(hit.distance);
+            }
+
+            return mismatches;
+        };
+
+        std::size_t mismatches = count_mesh_mismatches();
+        std::size_t bvh_bytes = mesh.get_bvh().get_nodes().size() * sizeof(BVH::Node);
+        float sah_cost = mesh.get_bvh().get_sah_cost();
+
+        start = std::chrono::steady_clock::now();
+        mesh.build_bvh(pool, BVH::Builder::Morton);
+        double morton_build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for(const Ray& ray : rays) {
+            Hit hit;
+            mesh.trace(ray, hit);
+        }
+        double morton_closest_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        mismatches += count_mesh_mismatches();
+
+        std::printf("    {\n");
+        std::printf("      \"triangles\": %zu,\n", mesh.get_triangle_count());
+        std::printf("      \"bvh_bytes\": %zu,\n", bvh_bytes);
+        std::printf("      \"sah_cost\": %.2f,\n", sah_cost);
+        std::printf("      \"build_time\": %.6f,\n", build_time);
+        std::printf("      \"parallel_build_time\": %.6f,\n", parallel_build_time);
+        std::printf("      \"hits\": %llu,\n      \"occluded\": %llu,\n", hits, occluded);
+        std::printf("      \"closest_hit_ns_per_ray\": %.1f,\n", closest_time * 1e9 / rays.size());
+        std::printf("      \"binary_closest_hit_ns_per_ray\": %.1f,\n", binary_time * 1e9 / rays.size());
+        std::printf("      \"wide_speedup\": %.2f,\n", binary_time / closest_time);
+        std::printf("      \"any_hit_ns_per_ray\": %.1f,\n", any_time * 1e9 / rays.size());
+        std::printf("      \"morton_sah_cost\": %.2f,\n", mesh.get_bvh().get_sah_cost());
+        std::printf("      \"morton_build_time\": %.6f,\n", morton_build_time);
+        std::printf("      \"morton_closest_hit_ns_per_ray\": %.1f,\n", morton_closest_time * 1e9 / rays.size());
+        std::printf("      \"mismatches\": %zu\n", mismatches);
+        std::printf("    }%s\n", r + 1 < std::size(ring_counts) ? "," : "");
+    }
+
+    std::printf("  ],\n");
+}
+
+/**
+ * @brief Times the serial and parallel BVH builds of 10M random boxes and compares them to the time
+ * a single thread takes to copy the boxes, which bounds how fast one pass over them can be. The
+ * Morton builds are timed the same way.
+ * @param pool The pool running the parallel build.
+ */
+void run_bvh_build(ThreadPool& pool) {
+    const std::size_t count = 10'000'000;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.01f, 1.0f);
+
+    std::vector<AABB> bounds(count);
+    for(AABB& box : bounds) {
+        vec3 min(position(generator), position(generator), position(generator));
+        box = AABB(min, min + vec3(size(generator), size(generator), size(generator)));
+    }
+
+    std::vector<AABB> copy(count);
+    auto start = std::chrono::steady_clock::now();
+    std::copy(bounds.begin(), bounds.end(), copy.begin());
+    double copy_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    copy = std::vector<AABB>();
+
+    start = std::chrono::steady_clock::now();
+    std::size_t serial_slots = BVH(bounds).get_nodes().size();
+    double serial_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    pool.reset_stats();
+    start = std::chrono::steady_clock::now();
+    std::size_t parallel_slots = BVH(bounds, pool).get_nodes().size();
+    double parallel_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double utilisation = 0.0;
+    for(const ThreadPool::WorkerStats& stats : pool.get_stats()) { utilisation += stats.utilisation; }
+
+    start = std::chrono::steady_clock::now();
+    BVH(bounds, BVH::Builder::Morton);
+    double morton_serial_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    BVH(bounds, pool, BVH::Builder::Morton);
+    double morton_parallel_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("  \"bvh_build\": {\n");
+    std::printf("    \"primitives\": %zu,\n", count);
+    std::printf("    \"slots\": %zu,\n    \"parallel_slots\": %zu,\n", serial_slots, parallel_slots);
+    std::printf("    \"copy_time\": %.6f,\n", copy_time);
+    std::printf("    \"serial_time\": %.6f,\n", serial_time);
+    std::printf("    \"parallel_time\": %.6f,\n", parallel_time);
+    std::printf("    \"parallel_time_over_copy_time\": %.1f,\n", parallel_time / copy_time);
+    std::printf("    \"mean_utilisation\": %.2f,\n", utilisation / pool.size());
+    std::printf("    \"morton_serial_time\": %.6f,\n", morton_serial_time);
+    std::printf("    \"morton_parallel_time\": %.6f\n", morton_parallel_time);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Compares the memory used by instances of a mesh against the same triangles flattened into
+ * one mesh per instance, and checks the instanced closest hits against a brute force traversal of
+ * every instance.
+ * @param rays The rays.
+ */
+void run_instancing(const std::vector<Ray>& rays) {
+    const std::size_t checked_rays = 256;
+
+    Scene scene = create_instances_scene(1, 1, 1, 64);
+    const InstanceSet& instances = scene.instances;
+    const TriangleMesh& mesh = instances.get_meshes().front();
+
+    unsigned long long hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(const Ray& ray : rays) {
+        Hit hit;
+        hits += instances.trace(ray, hit);
+    }
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t mismatches = 0;
+    for(std::size_t i = 0 ; i < std::min(checked_rays, rays.size()) ; ++i) {
+        Hit reference;
+        Hit hit;
+        for(std::uint32_t instance = 0 ; instance < instances.size() ; ++instance) {
+            instances.intersect(instance, rays[i], reference);
+        }
+        instances.trace(rays[i], hit);
+        mismatches += std::bit_cast<std::uint32_t>(reference.distance) != std::bit_cast<std::uint32_t>(hit.distance);
+    }
+
+    std::printf("  \"instancing\": {\n");
+    std::printf("    \"instances\": %zu,\n", instances.size());
+    std::printf("    \"triangles\": %zu,\n", instances.size() * mesh.get_triangle_count());
+    std::printf("    \"bytes\": %zu,\n", instances.get_memory_usage());
+    std::printf("    \"flattened_bytes\": %zu,\n", instances.size() * mesh.get_memory_usage());
+    std::printf("    \"hits\": %llu,\n", hits);
+    std::printf("    \"closest_hit_ns_per_ray\": %.1f,\n", time * 1e9 / rays.size());
+    std::printf("    \"mismatches\": %zu\n", mismatches);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Times moving the vertices of a tessellated sphere, which refits its BVHs, against building
+ * them again for the same positions. A small wobble keeps the refitted BVH, while scattering the
+ * vertices degrades it enough to trigger a rebuild. The closest hits of the first rays are checked
+ * against a brute force traversal after each update.
+ * @param pool The pool running the updates and the builds.
+ * @param rays The rays.
+ */
+void run_bvh_refit(ThreadPool& pool, const std::vector<Ray>& rays) {
+    const std::size_t checked_rays = 256;
+    const vec3 center(0.0f, 0.0f, -3.0f);
+
+    TriangleMesh mesh = create_uv_sphere(center, 1.0f, 256, 512);
+    mesh.build_bvh(pool);
+    const std::vector<vec3> rest_positions = mesh.get_positions();
+
+    std::vector<vec3> wobbled(rest_positions);
+    for(vec3& position : wobbled) {
+        vec3 offset = position - center;
+        position = center + offset * (1.0f + 0.05f * std::sin(8.0f * offset.x) * std::sin(8.0f * offset.y));
+    }
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+    std::vector<vec3> scattered(rest_positions);
+    for(vec3& position : scattered) {
+        position = center + vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+    }
+
+    std::printf("  \"bvh_refit\": [\n");
+
+    const std::pair<const char*, const std::vector<vec3>*> deformations[]{ { "wobble", &wobbled }, { "scatter", &scattered } };
+    for(std::size_t d = 0 ; d < std::size(deformations) ; ++d) {
+        mesh.set_positions(rest_positions, pool);
+
+        auto start = std::chrono::steady_clock::now();
+        bool rebuilt = mesh.set_positions(*deformations[d].second, pool);
+        double refit_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        float refit_sah_cost = mesh.get_bvh().get_sah_cost();
+
+        std::size_t mismatches = 0;
+        for(std::size_t i = 0 ; i < std::min(checked_rays, rays.size()) ; ++i) {
+            Hit reference;
+            Hit hit;
+            mesh.intersect(rays[i], reference);
+            mesh.trace(rays[i], hit);
+            mismatches += std::bit_cast<std::uint32_t>(reference.distance) != std::bit_cast<std::uint32_t>(hit.distance);
+        }
+
+        start = std::chrono::steady_clock::now();
+        mesh.build_bvh(pool);
+        double build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("    {\n");
+        std::printf("      \"deformation\": \"%s\",\n", deformations[d].first);
+        std::printf("      \"triangles\": %zu,\n", mesh.get_triangle_count());
+        std::printf("      \"rebuilt\": %s,\n", rebuilt ? "true" : "false");
+        std::printf("      \"update_time\": %.6f,\n", refit_time);
+        std::printf("      \"build_time\": %.6f,\n", build_time);
+        std::printf("      \"sah_cost\": %.2f,\n", refit_sah_cost);
+        std::printf("      \"built_sah_cost\": %.2f,\n", mesh.get_bvh().get_sah_cost());
+        std::printf("      \"mismatches\": %zu\n", mismatches);
+        std::printf("    }%s\n", d + 1 < std::size(deformations) ? "," : "");
+    }
+
+    std::printf("  ],\n");
+}
+
+/**
+ * @brief Writes a tessellated sphere of 1M triangles in a temporary OBJ file, then times loading it
+ * with the OBJ loader, serially and in parallel, against reading it with the stream operators. The
+ * positions are written with enough digits to be read back exactly, so the loaded mesh is checked
+ * against the written one. The float parser is also checked against std::from_chars on decimals of
+ * 15 to 17 digits close to the midpoints between floats, where rounding twice would go wrong.
+ * @param pool The pool running the parallel load.
+ */
+void run_obj_loading(ThreadPool& pool) {
+    const TriangleMesh mesh = create_uv_sphere(vec3(0.0f, 0.0f, -3.0f), 1.0f, 512, 1024);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "Ray-Tracing-bench.obj";
+
+    {
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if(file == nullptr) { throw std::runtime_error("Failed to create file '" + path.string() + '\''); }
+
+        std::fprintf(file, "# UV sphere\no sphere\n");
+        for(const vec3& position : mesh.get_positions()) {
+            std::fprintf(file, "v %.9g %.9g %.9g\n", position.x, position.y, position.z);
+        }
+        const std::vector<std::uint32_t>& indices = mesh.get_indices();
+        for(std::size_t i = 0 ; i < indices.size() ; i += 3) {
+            std::fprintf(file, "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1);
+        }
+        std::fclose(file);
+    }
+
+    const std::uintmax_t bytes = std::filesystem::file_size(path);
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t stream_vertices = 0;
+    {
+        std::ifstream stream(path);
+        std::string keyword;
+        while(stream >> keyword) {
+            if(keyword == "v") {
+                vec3 position;
+                stream >> position;
+                ++stream_vertices;
+            } else if(keyword == "f") {
+                std::uint32_t index;
+                stream >> index >> index >> index;
+            } else {
+                std::getline(stream, keyword);
+            }
+        }
+    }
+    double stream_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    TriangleMesh serial = load_obj(path);
+    double serial_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    TriangleMesh parallel = load_obj(path, pool);
+    double parallel_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::filesystem::remove(path);
+
+    std::size_t mismatches = stream_vertices != mesh.get_positions().size();
+    for(const TriangleMesh* loaded : { &serial, &parallel }) {
+        mismatches += loaded->get_indices() != mesh.get_indices();
+        mismatches += !std::equal(mesh.get_positions().begin(), mesh.get_positions().end(),
+                                  loaded->get_positions().begin(), loaded->get_positions().end(),
+                                  [](const vec3& left, const vec3& right) {
+            return left.x == right.x && left.y == right.y && left.z == right.z;
+        });
+    }
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+    std::uniform_int_distribution<int> digit_count(15, 17);
+    std::uniform_int_distribution<int> offset(-2, 2);
+
+    std::size_t parse_mismatches = 0;
+    for(unsigned int i = 0 ; i < 1 << 20 ; ++i) {
+        float lower = coordinate(generator);
+        double midpoint = 0.5 * (static_cast<double>(lower) + std::nextafter(lower, std::numeric_limits<float>::infinity()));
+        double number = midpoint + offset(generator) * std::numeric_limits<double>::epsilon() * std::abs(midpoint);
+
+        char text[32];
+        int length = std::snprintf(text, sizeof(text), "%.*e", digit_count(generator) - 1, number);
+
+        const char* cursor = text;
+        float parsed;
+        float reference;
+        parse_float(cursor, text + length, parsed);
+        std::from_chars(text, text + length, reference);
+        parse_mismatches += std::bit_cast<std::uint32_t>(parsed) != std::bit_cast<std::uint32_t>(reference);
+    }
+
+    std::printf("  \"obj_loading\": {\n");
+    std::printf("    \"bytes\": %ju,\n", bytes);
+    std::printf("    \"triangles\": %zu,\n", parallel.get_triangle_count());
+    std::printf("    \"stream_time\": %.6f,\n", stream_time);
+    std::printf("    \"serial_time\": %.6f,\n", serial_time);
+    std::printf("    \"parallel_time\": %.6f,\n", parallel_time);
+    std::printf("    \"parallel_megabytes_per_second\": %.1f,\n", bytes / parallel_time * 1e-6);
+    std::printf("    \"parse_mismatches\": %zu,\n", parse_mismatches);
+    std::printf("    \"mismatches\": %zu\n", mismatches);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Writes a mesh in a binary PLY file.
+ * @param mesh The mesh.
+ * @param path The path of the file.
+ * @param is_converted Whether the positions are written as doubles and the faces with an extra
+ * property, so that they cannot be read in place.
+ */
+void write_ply_file(const TriangleMesh& mesh, const std::filesystem::path& path, bool is_converted) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if(file == nullptr) { throw std::runtime_error("Failed to create file '" + path.string() + '\''); }
+
+    auto write = [file](const auto& value) { std::fwrite(&value, sizeof(value), 1, file); };
+
+    const char* position_type = is_converted ? "double" : "float";
+    std::fprintf(file, "ply\nformat binary_little_endian 1.0\ncomment UV sphere\n");
+    std::fprintf(file, "element vertex %zu\n", mesh.get_positions().size());
+    std::fprintf(file, "property %s x\nproperty %s y\nproperty %s z\n", position_type, position_type, position_type);
+    std::fprintf(file, "element face %zu\nproperty list uchar int vertex_indices\n", mesh.get_triangle_count());
+    if(is_converted) { std::fprintf(file, "property uchar flags\n"); }
+    std::fprintf(file, "end_header\n");
+
+    for(const vec3& position : mesh.get_positions()) {
+        for(float coordinate : { position.x, position.y, position.z }) {
+            if(is_converted) { write(static_cast<double>(coordinate)); } else { write(coordinate); }
+        }
+    }
+
+    const std::vector<std::uint32_t>& indices = mesh.get_indices();
+    for(std::size_t i = 0 ; i < indices.size() ; i += 3) {
+        write(std::uint8_t(3));
+        write(indices[i]);
+        write(indices[i + 1]);
+        write(indices[i + 2]);
+        if(is_converted) { write(std::uint8_t(0)); }
+    }
+
+    std::fclose(file);
+}
+
+/**
+ * @brief Writes a tessellated sphere of 1M triangles in two temporary binary PLY files, then times
+ * loading them against reading their bytes into a buffer. The first one stores float positions and
+ * triangles of 32-bit indices, which are read in place from the mapping; the second one stores
+ * double positions and faces with an extra property, which are converted.
+ * @param pool The pool running the loads.
+ */
+void run_ply_loading(ThreadPool& pool) {
+    const TriangleMesh mesh = create_uv_sphere(vec3(0.0f, 0.0f, -3.0f), 1.0f, 512, 1024);
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+
+    const std::pair<const char*, bool> layouts[]{ { "direct", false }, { "converted", true } };
+    std::printf("  \"ply_loading\": [\n");
+
+    for(std::size_t l = 0 ; l < std::size(layouts) ; ++l) {
+        const auto [name, is_converted] = layouts[l];
+        const std::filesystem::path path = directory / ("Ray-Tracing-bench-" + std::string(name) + ".ply");
+
+        write_ply_file(mesh, path, is_converted);
+
+        const std::uintmax_t bytes = std::filesystem::file_size(path);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<char> buffer(bytes);
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if(file == nullptr) { throw std::runtime_error("Failed to open file '" + path.string() + '\''); }
+            if(std::fread(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+                throw std::runtime_error("Failed to read file '" + path.string() + '\'');
+            }
+            std::fclose(file);
+        }
+        double read_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const PlyFile file(path);
+        bool is_in_place = !file.get_positions().empty() && !file.get_triangles().empty();
+        TriangleMesh loaded = file.create_mesh(pool);
+        double load_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::filesystem::remove(path);
+
+        std::size_t mismatches = loaded.get_indices() != mesh.get_indices();
+        mismatches += loaded.get_positions() != mesh.get_positions();
+
+        std::printf("    {\n");
+        std::printf("      \"layout\": \"%s\",\n", name);
+        std::printf("      \"bytes\": %ju,\n", bytes);
+        std::printf("      \"triangles\": %zu,\n", loaded.get_triangle_count());
+        std::printf("      \"in_place\": %s,\n", is_in_place ? "true" : "false");
+        std::printf("      \"read_time\": %.6f,\n", read_time);
+        std::printf("      \"load_time\": %.6f,\n", load_time);
+        std::printf("      \"megabytes_per_second\": %.1f,\n", bytes / load_time * 1e-6);
+        std::printf("      \"mismatches\": %zu\n", mismatches);
+        std::printf("    }%s\n", l + 1 < std::size(layouts) ? "," : "");
+    }
+
+    std::printf("  ],\n");
+}
+
+/**
+ * @brief Writes a tessellated sphere of 1M triangles in a temporary PLY file, then loads it through
+ * a mesh cache twice. The first load misses: it loads the file, builds the BVHs and writes the cache
+ * file. The second one reads the mesh and its BVHs back from the cache file. The closest hits of the
+ * first rays are compared between both meshes.
+ * @param pool The pool running the loads and the build.
+ * @param rays The rays.
+ */
+void run_mesh_cache(ThreadPool& pool, const std::vector<Ray>& rays) {
+    constexpr std::size_t checked_rays = 4096;
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "Ray-Tracing-bench-cache";
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "Ray-Tracing-bench-cache.ply";
+    write_ply_file(create_uv_sphere(vec3(0.0f, 0.0f, -3.0f), 1.0f, 512, 1024), path, false);
+
+    MeshCache cache(directory.string());
+    std::filesystem::remove(cache.get_cache_path(path.string(), BVH::Builder::SAH));
+
+    auto start = std::chrono::steady_clock::now();
+    const TriangleMesh built = cache.load(path.string(), pool);
+    double miss_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    const TriangleMesh cached = cache.load(path.string(), pool);
+    double hit_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const std::uintmax_t bytes = std::filesystem::file_size(cache.get_cache_path(path.string(), BVH::Builder::SAH));
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(path);
+
+    std::size_t mismatches = cache.get_hit_count() != 1 || cache.get_miss_count() != 1;
+    for(std::size_t i = 0 ; i < std::min(checked_rays, rays.size()) ; ++i) {
+        Hit reference;
+        Hit hit;
+        built.trace(rays[i], reference);
+        cached.trace(rays[i], hit);
+        mismatches += std::bit_cast<std::uint32_t>(reference.distance) != std::bit_cast<std::uint32_t>(hit.distance);
+    }
+
+    std::printf("  \"mesh_cache\": {\n");
+    std::printf("    \"triangles\": %zu,\n", cached.get_triangle_count());
+    std::printf("    \"bytes\": %ju,\n", bytes);
+    std::printf("    \"miss_time\": %.6f,\n", miss_time);
+    std::printf("    \"hit_time\": %.6f,\n", hit_time);
+    std::printf("    \"speedup\": %.1f,\n", miss_time / hit_time);
+    std::printf("    \"mismatches\": %zu\n", mismatches);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Writes a scene description of 256K spheres of 256 materials in a temporary file, then times
+ * loading it, which parses it and builds the BVH of the spheres, against building the same BVH.
+ * @param pool The pool building the BVHs.
+ */
+void run_scene_loading(ThreadPool& pool) {
+    constexpr unsigned int sphere_count = 1 << 18;
+    constexpr unsigned int material_count = 256;
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "Ray-Tracing-bench.scene";
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> channel(0.0f, 1.0f);
+
+    SphereSet spheres;
+    {
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if(file == nullptr) { throw std::runtime_error("Failed to create file '" + path.string() + '\''); }
+
+        std::fprintf(file, "# Random spheres\nresolution 1280 720\nsamples 4\n");
+        std::fprintf(file, "camera 0 0 20   0 0 0   0 1 0   60\nsky 1 1 1   0.5 0.7 1\n");
+        for(unsigned int i = 0 ; i < material_count ; ++i) {
+            std::fprintf(file, "material m%u %.9g %.9g %.9g\n", i, channel(generator), channel(generator), channel(generator));
+        }
+        for(unsigned int i = 0 ; i < sphere_count ; ++i) {
+            vec3 center(coordinate(generator), coordinate(generator), coordinate(generator));
+            float radius = 0.01f + 0.05f * channel(generator);
+            std::fprintf(file, "sphere %.9g %.9g %.9g %.9g m%u\n", center.x, center.y, center.z, radius, i % material_count);
+            spheres.add(center, radius, 1 + i % material_count);
+        }
+        std::fclose(file);
+    }
+
+    const std::uintmax_t bytes = std::filesystem::file_size(path);
+
+    auto start = std::chrono::steady_clock::now();
+    spheres.build_bvh(pool);
+    double build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    const Scene scene = load_scene(path.string(), pool);
+    double load_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::filesystem::remove(path);
+
+    std::size_t mismatches = scene.spheres.size() != spheres.size() || scene.materials.size() != material_count + 1;
+    for(std::size_t i = 0 ; i < std::min(scene.spheres.size(), spheres.size()) ; ++i) {
+        mismatches += scene.spheres.get_center(i) != spheres.get_center(i)
+                      || scene.spheres.get_radius(i) != spheres.get_radius(i)
+                      || scene.spheres.get_material(i) != spheres.get_material(i);
+    }
+
+    std::printf("  \"scene_loading\": {\n");
+    std::printf("    \"bytes\": %ju,\n", bytes);
+    std::printf("    \"spheres\": %zu,\n", scene.spheres.size());
+    std::printf("    \"build_time\": %.6f,\n", build_time);
+    std::printf("    \"load_time\": %.6f,\n", load_time);
+    std::printf("    \"parse_megabytes_per_second\": %.1f,\n", bytes / std::max(load_time - build_time, 1e-6) * 1e-6);
+    std::printf("    \"mismatches\": %zu\n", mismatches);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Renders a 1080p scene then times writing it in every output format, and reads the PFM file
+ * back to check it holds the exact floats of the pixels.
+ * @param pool The pool rendering the scene.
+ */
+void run_image_output(ThreadPool& pool) {
+    const Scene scene = create_spheres_scene(1920, 1080, 1, 256);
+    Image image(scene.width, scene.height);
+    Renderer(pool).render(scene, image);
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const char* const extensions[]{ ".png", ".pfm", ".hdr" };
+
+    std::printf("  \"image_output\": {\n");
+    std::printf("    \"pixels\": %u,\n", image.width * image.height);
+
+    for(const char* extension : extensions) {
+        const std::string path = (directory / (std::string("Ray-Tracing-bench") + extension)).string();
+
+        auto start = std::chrono::steady_clock::now();
+        image.write(path);
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("    \"%s\": { \"bytes\": %ju, \"time\": %.6f },\n", extension + 1,
+                    std::filesystem::file_size(path), time);
+    }
+
+    /* The floats follow the 3 lines of the header */
+    const std::filesystem::path path = directory / "Ray-Tracing-bench.pfm";
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    for(int i = 0 ; i < 3 ; ++i) { std::getline(file, line); }
+
+    std::size_t mismatches = 0;
+    std::vector<float> row(image.width * 3);
+    for(unsigned int j = 0 ; j < image.height ; ++j) {
+        file.read(reinterpret_cast<char*>(row.data()), row.size() * sizeof(float));
+        for(unsigned int i = 0 ; i < image.width ; ++i) {
+            const vec3& pixel = image(i, j);
+            mismatches += !file || row[3 * i] != pixel.r || row[3 * i + 1] != pixel.g || row[3 * i + 2] != pixel.b;
+        }
+    }
+    file.close();
+
+    for(const char* extension : extensions) {
+        std::filesystem::remove(directory / (std::string("Ray-Tracing-bench") + extension));
+    }
+
+    std::printf("    \"mismatches\": %zu\n", mismatches);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Compares the vec3 operators and geometric functions of the SIMD backend against their scalar
+ * formulas on 1M random vectors, a sixteenth of which hold zeros and infinities, and checks that the
+ * padding lane of every result stays 0. The component-wise results must be identical, the sums of
+ * products are allowed the rounding of another summation order.
+ */
+void run_vec3_check() {
+    constexpr unsigned int vector_count = 1 << 20;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+    std::uniform_int_distribution<int> special(0, 15);
+
+    const float specials[]{ 0.0f, -0.0f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+    auto draw = [&] {
+        return special(generator) == 0 ? specials[special(generator) % std::size(specials)] : coordinate(generator);
+    };
+
+    /* NaN matches NaN, and the sums of products may differ by a few ulps */
+    auto same = [](float result, float reference, bool is_exact) {
+        if(std::isnan(result) || std::isnan(reference)) { return std::isnan(result) && std::isnan(reference); }
+        if(is_exact || std::isinf(result) || std::isinf(reference)) { return result == reference; }
+        return std::abs(result - reference) <= 1e-5f * std::max(1.0f, std::abs(reference));
+    };
+
+    std::size_t mismatches = 0;
+    std::size_t padding_errors = 0;
+
+    auto check = [&](const vec3& result, float x, float y, float z, bool is_exact) {
+        mismatches += !same(result.x, x, is_exact) || !same(result.y, y, is_exact) || !same(result.z, z, is_exact);
+#ifdef MATHS_SIMD_SSE4
+        padding_errors += result.padding != 0.0f;
+#endif
+    };
+
+    for(unsigned int i = 0 ; i < vector_count ; ++i) {
+        const vec3 a(draw(), draw(), draw());
+        const vec3 b(draw(), draw(), draw());
+        const float value = draw();
+
+        check(a + b, a.x + b.x, a.y + b.y, a.z + b.z, true);
+        check(a - b, a.x - b.x, a.y - b.y, a.z - b.z, true);
+        check(a * b, a.x * b.x, a.y * b.y, a.z * b.z, true);
+        check(a * value, a.x * value, a.y * value, a.z * value, true);
+        check(value * a, value * a.x, value * a.y, value * a.z, true);
+        check(a / value, a.x / value, a.y / value, a.z / value, true);
+        check(-a, -a.x, -a.y, -a.z, true);
+        check(min(a, b), std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z), true);
+        check(max(a, b), std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z), true);
+
+        vec3 scaled = a;
+        scaled *= value;
+        check(scaled, a.x * value, a.y * value, a.z * value, true);
+        scaled = a;
+        scaled /= value;
+        check(scaled, a.x / value, a.y / value, a.z / value, true);
+
+        check(cross(a, b), a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, false);
+
+        const float length_squared = a.x * a.x + a.y * a.y + a.z * a.z;
+        const float reference_length = std::sqrt(length_squared);
+        check(normalize(a), a.x / reference_length, a.y / reference_length, a.z / reference_length, false);
+        mismatches += !same(dot(a, b), a.x * b.x + a.y * b.y + a.z * b.z, false);
+        mismatches += !same(length(a), reference_length, false);
+
+        /* The padding must not leak into a sum even after a division by zero */
+        const vec3 divided = a / 0.0f;
+        mismatches += !same(dot(divided, vec3(1.0f)), divided.x + divided.y + divided.z, false);
+        check(divided, a.x / 0.0f, a.y / 0.0f, a.z / 0.0f, true);
+    }
+
+    std::printf("  \"vec3_check\": {\n");
+    std::printf("    \"vectors\": %u,\n", vector_count);
+    std::printf("    \"padding_errors\": %zu,\n", padding_errors);
+    std::printf("    \"mismatches\": %zu\n", mismatches);
+    std::printf("  },\n");
+}
+
+/**
+ * @brief Opens a counter of the instructions retired by the calling thread.
+ * @return The file descriptor of the counter, -1 if the kernel does not allow it.
+ */
+int open_instruction_counter() {
+    perf_event_attr attributes{};
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+
+/**
+ * @brief Generates the primary rays of a 1025x512 frame and shades them with the sky gradient on the
+ * calling thread, the per-pixel kernel the inlined maths module is meant to fuse. Reports the time
+ * and, when the kernel allows hardware counters, the instructions per ray.
+ */
+void run_primary_rays() {
+    constexpr unsigned int width = 1025;
+    constexpr unsigned int height = 512;
+    constexpr unsigned int frames = 20;
+
+    const Camera camera(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f), 90.0f, width, height);
+    const vec3 sky_bottom(1.0f);
+    const vec3 sky_top(0.5f, 0.7f, 1.0f);
+    Image image(width, height);
+
+    auto render = [&] {
+        for(unsigned int j = 0 ; j < height ; ++j) {
+            for(unsigned int i = 0 ; i < width ; ++i) {
+                const Ray ray = camera.get_ray(i + 0.5f, j + 0.5f);
+                const float t = 0.5f + 0.5f * ray.direction.y;
+                image(i, j) = (1.0f - t) * sky_bottom + t * sky_top;
+            }
+        }
+    };
+
+    render();
+
+    const int counter = open_instruction_counter();
+    if(counter != -1) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int frame = 0 ; frame < frames ; ++frame) { render(); }
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long instructions = -1;
+    if(counter != -1) {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(counter, &instructions, sizeof(instructions)) != sizeof(instructions)) { instructions = -1; }
+        close(counter);
+    }
+
+    const double rays = static_cast<double>(width) * height * frames;
+
+    std::printf("  \"primary_rays\": {\n");
+    std::printf("    \"rays\": %.0f,\n", rays);
+    std::printf("    \"nanoseconds_per_ray\": %.2f,\n", time / rays * 1e9);
+    if(instructions >= 0) {
+        std::printf("    \"instructions_per_ray\": %.1f,\n", instructions / rays);
+    } else {
+        std::printf("    \"instructions_per_ray\": null,\n");
+    }
+    /* Reading pixels back keeps the stores of the kernel from being optimised away */
+    std::printf("    \"checksum\": %.3f\n", image(width / 2, height / 2).r + image(0, 0).g + image(width - 1, height - 1).b);
+    std::printf("  },\n");
+}
+
+void run_kernels(ThreadPool& pool) {
+    Scene scene = create_spheres_scene(1, 1, 1, 1024);
+    const SphereSet& spheres = scene.spheres;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+
+    std::vector<Ray> rays;
+    rays.reserve(1 << 16);
+    for(unsigned int i = 0 ; i < 1 << 16 ; ++i) {
+        rays.emplace_back(vec3(0.0f), vec3(0.5f * coordinate(generator), 0.5f * coordinate(generator), -1.0f));
+    }
+
+    /* About a thousand triangles, like the spheres */
+    TriangleMesh mesh = create_uv_sphere(vec3(0.0f, 0.0f, -3.0f), 1.0f, 16, 32);
+
+    std::vector<Hit> reference_hits;
+    std::vector<Hit> batched_hits;
+
+    std::printf("  \"kernels\": [\n");
+
+    double sphere_reference = time_kernel("sphere-scalar", [&](const Ray& ray, Hit& hit) {
+        return spheres.intersect_reference(ray, hit);
+    }, spheres.size(), rays, reference_hits);
+    std::printf(",\n");
+
+    double sphere_batched = time_kernel("sphere-batched", [&](const Ray& ray, Hit& hit) {
+        return spheres.intersect(ray, hit);
+    }, spheres.size(), rays, batched_hits);
+    std::printf(",\n");
+
+    double triangle_reference = time_kernel("triangle-scalar", [&](const Ray& ray, Hit& hit) {
+        return mesh.intersect_reference(ray, hit);
+    }, mesh.get_triangle_count(), rays, reference_hits);
+    std::printf(",\n");
+
+    double triangle_batched = time_kernel("triangle-batched", [&](const Ray& ray, Hit& hit) {
+        return mesh.intersect(ray, hit);
+    }, mesh.get_triangle_count(), rays, batched_hits);
+
+    std::printf("\n  ],\n  \"sphere_speedup\": %.2f,\n", sphere_reference / sphere_batched);
+    std::printf("  \"triangle_speedup\": %.2f,\n", triangle_reference / triangle_batched);
+    std::printf("  \"triangle_mismatches\": %zu,\n", count_mismatches(reference_hits, batched_hits));
+
+    run_vec3_check();
+    run_primary_rays();
+    run_bvh_scaling(pool, rays);
+    run_bvh_build(pool);
+    run_instancing(rays);
+    run_bvh_refit(pool, rays);
+    run_obj_loading(pool);
+    run_ply_loading(pool);
+    run_mesh_cache(pool, rays);
+    run_scene_loading(pool);
+    run_image_output(pool);
+}
+
+void run(unsigned int frames) {
+    auto sky = [](unsigned int width, unsigned int height, unsigned int samples) {
+        Camera camera(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f), 90.0f, width, height);
+        return Scene(width, height, samples, camera);
+    };
+
+    const std::vector<Benchmark> benchmarks{
+        { "sky-720p-1spp", sky(1280, 720, 1) },
+        { "sky-1080p-4spp", sky(1920, 1080, 4) },
+        { "sky-2160p-1spp", sky(3840, 2160, 1) },
+        { "spheres64-720p-1spp", create_spheres_scene(1280, 720, 1, 64) },
+        { "spheres256-1080p-1spp", create_spheres_scene(1920, 1080, 1, 256) },
+        { "mesh1k-720p-1spp", create_mesh_scene(1280, 720, 1, 16) },
+        { "mesh1m-720p-1spp", create_mesh_scene(1280, 720, 1, 512) },
+        { "instances4k-720p-1spp", create_instances_scene(1280, 720, 1, 64) },
+    };
+
+    ThreadPool pool;
+    Renderer renderer(pool);
+
+    std::printf("{\n  \"threads\": %u,\n  \"frames\": %u,\n  \"scenes\": [\n", pool.size(), frames);
+
+    for(std::size_t b = 0 ; b < benchmarks.size() ; ++b) {
+        const Benchmark& benchmark = benchmarks[b];
+        const Scene& scene = benchmark.scene;
+        Image image(scene.width, scene.height);
+
+        /* Warm up then time every frame */
+        renderer.render(scene, image);
+
+        std::vector<double> frame_times;
+        pool.reset_stats();
+        for(unsigned int frame = 0 ; frame < frames ; ++frame) {
+            auto start = std::chrono::steady_clock::now();
+            renderer.render(scene, image);
+            frame_times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        double wall_time = 0.0;
+        for(double frame_time : frame_times) { wall_time += frame_time; }
+        std::sort(frame_times.begin(), frame_times.end());
+
+        double utilisation = 0.0;
+        for(const ThreadPool::WorkerStats& stats : pool.get_stats()) { utilisation += stats.utilisation; }
+
+        double samples = static_cast<double>(scene.width) * scene.height * scene.samples * frames;
+        double rays = samples;
+
+        std::printf("    {\n");
+        std::printf("      \"name\": \"%s\",\n", benchmark.name);
+        std::printf("      \"width\": %u,\n      \"height\": %u,\n      \"samples\": %u,\n",
+                    scene.width, scene.height, scene.samples);
+        std::printf("      \"wall_time\": %.6f,\n", wall_time);
+        std::printf("      \"frame_time_min\": %.6f,\n", frame_times.front());
+        std::printf("      \"frame_time_median\": %.6f,\n", frame_times[frame_times.size() / 2]);
+        std::printf("      \"rays_per_second\": %.1f,\n", rays / wall_time);
+        std::printf("      \"samples_per_second\": %.1f,\n", samples / wall_time);
+        std::printf("      \"mean_utilisation\": %.2f,\n", utilisation / pool.size());
+        std::printf("      \"peak_rss\": %lld\n", get_peak_rss());
+        std::printf("    }%s\n", b + 1 < benchmarks.size() ? "," : "");
+    }
+
+    std::printf("  ],\n");
+
+    run_kernels(pool);
+
+    std::printf("  \"peak_rss\": %lld\n}\n", get_peak_rss());
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        unsigned int frames = argc > 1 ? std::stoul(argv[1]) : 5;
+        run(std::max(frames, 1u));
+    } catch(const std::exception& exception) {
+        std::cerr << "ERROR : " << exception.what() << '\n';
+        return -1;
+    }
+
+    return 0;
+}
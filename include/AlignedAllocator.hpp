@@ -0,0 +1,49 @@
+/***************************************************************************************************
+ * @file  AlignedAllocator.hpp
+ * @brief Declaration of the AlignedAllocator struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * @struct AlignedAllocator
+ * @brief An allocator whose allocations are aligned on a given boundary, so that the arrays it
+ * allocates can be loaded into SIMD registers with aligned loads.
+ * @tparam T The type of the allocated elements.
+ * @tparam Alignment The alignment in bytes.
+ */
+template<typename T, std::size_t Alignment = 32>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* pointer, std::size_t) {
+        ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator ==(const AlignedAllocator<U, Alignment>&) const { return true; }
+};
+
+/**
+ * @brief A std::vector whose storage is aligned on 32 bytes.
+ */
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
@@ -0,0 +1,95 @@
+/***************************************************************************************************
+ * @file  Camera.hpp
+ * @brief Declaration of the Camera class
+ **************************************************************************************************/
+
+#pragma once
+
+#include "Ray.hpp"
+#include "RayPacket.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @class Camera
+ * @brief A pinhole camera. Its basis and per-pixel deltas are computed once so that the direction
+ * of a pixel's ray is obtained by adding a delta to the previous pixel's direction.
+ */
+class Camera {
+public:
+    /**
+     * @brief Constructs a camera.
+     * @param position The position of the camera.
+     * @param look_at The point the camera looks at.
+     * @param up The up direction of the world.
+     * @param fov The vertical field of view in degrees.
+     * @param width The width of the image in pixels.
+     * @param height The height of the image in pixels, the aspect ratio being width / height.
+     */
+    Camera(const vec3& position, const vec3& look_at, const vec3& up, float fov, unsigned int width,
+           unsigned int height);
+
+    /**
+     * @brief Gives the unnormalized direction going through a point of the image.
+     * @param x The horizontal position of the point, in pixels.
+     * @param y The vertical position of the point, in pixels, 0 being the bottom of the image.
+     * @return The direction.
+     */
+    vec3 get_direction(float x, float y) const;
+
+    /**
+     * @brief Gives the ray going through a point of the image.
+     * @param x The horizontal position of the point, in pixels.
+     * @param y The vertical position of the point, in pixels, 0 being the bottom of the image.
+     * @return The ray.
+     */
+    Ray get_ray(float x, float y) const;
+
+    /**
+     * @brief Fills a packet with the rays of 8 horizontally adjacent pixels.
+     * @param packet The packet to fill.
+     * @param direction The unnormalized direction of the first ray, the next ones being
+     * pixel_delta_u apart.
+     */
+    void generate(RayPacket8& packet, const vec3& direction) const;
+
+    /**
+     * @brief Gives the position of the camera.
+     * @return The position.
+     */
+    const vec3& get_position() const;
+
+    /**
+     * @brief Gives the difference between the directions of two horizontally adjacent pixels.
+     * @return The horizontal pixel delta.
+     */
+    const vec3& get_pixel_delta_u() const;
+
+    /**
+     * @brief Gives the difference between the directions of the first rays of two consecutive
+     * packets.
+     * @return The packet delta.
+     */
+    const vec3& get_packet_delta_u() const;
+
+    /**
+     * @brief Gives the aspect ratio of the image.
+     * @return The width divided by the height.
+     */
+    float get_aspect() const;
+
+private:
+    vec3 position;
+    vec3 u;
+    vec3 v;
+    vec3 w;
+
+    float aspect;
+    vec3 bottom_left;
+    vec3 pixel_delta_u;
+    vec3 pixel_delta_v;
+    vec3 packet_delta_u;
+
+    alignas(32) float lane_delta_x[RayPacket8::size];
+    alignas(32) float lane_delta_y[RayPacket8::size];
+    alignas(32) float lane_delta_z[RayPacket8::size];
+};
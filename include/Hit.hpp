@@ -0,0 +1,21 @@
+/***************************************************************************************************
+ * @file  Hit.hpp
+ * @brief Declaration of the Hit struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include <limits>
+
+/**
+ * @struct Hit
+ * @brief The closest intersection found so far along a ray. Intersection routines only accept
+ * hits closer than distance, so the same Hit can be passed to several of them.
+ */
+struct Hit {
+    static constexpr float min_distance = 1e-4f; ///< Hits closer than this are ignored.
+
+    float distance = std::numeric_limits<float>::infinity(); ///< The distance along the ray.
+    unsigned int primitive = 0;                               ///< The index of the hit primitive.
+    unsigned int instance = 0;                                ///< The index of the hit instance, if instanced.
+};
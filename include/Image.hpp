@@ -5,24 +5,110 @@
 
 #pragma once
 
+#include <cstddef>
+#include <span>
+#include <string>
+
 #include "maths/vec3.hpp"
 
+/**
+ * @struct Tile
+ * @brief A rectangular region of an image covering the pixels [x_min, x_max) x [y_min, y_max).
+ */
+struct Tile {
+    unsigned int x_min; ///< The first column of the tile.
+    unsigned int y_min; ///< The first row of the tile.
+    unsigned int x_max; ///< One past the last column of the tile.
+    unsigned int y_max; ///< One past the last row of the tile.
+};
+
 /**
  * @struct Image
- * @brief
+ * @brief A framebuffer stored as a single contiguous row-major array of pixels, aligned on a cache
+ * line. Row 0 is the bottom of the image.
  */
 struct Image {
+    /**
+     * @brief The alignment of the pixel buffer in bytes.
+     */
+    static constexpr std::size_t alignment = 64;
+
+    /**
+     * @enum Format
+     * @brief The file formats an image can be written in.
+     */
+    enum class Format {
+        PNG, ///< 8 bits per channel, clamped to [0, 1] and compressed.
+        PFM, ///< Portable float map, the raw 32-bit floats of the pixels.
+        HDR  ///< Radiance RGBE, a shared 8-bit exponent per pixel, run-length encoded.
+    };
+
+    /**
+     * @brief Gives the format of an image file from its extension, .png, .pfm or .hdr.
+     * @param path The path of the file.
+     * @return The format.
+     */
+    static Format get_format(const std::string& path);
+
     Image(unsigned int width, unsigned int height);
 
     ~Image();
 
-    vec3& operator()(unsigned int row, unsigned int column);
+    /**
+     * @brief Takes ownership of another image's pixels, leaving it empty.
+     * @param image The image to move from.
+     */
+    Image(Image&& image) noexcept;
+
+    Image(const Image&) = delete;
+    Image& operator =(const Image&) = delete;
+
+    /**
+     * @brief Accesses a pixel.
+     * @param column The column of the pixel.
+     * @param row The row of the pixel.
+     * @return A reference to the pixel.
+     */
+    vec3& operator ()(unsigned int column, unsigned int row);
+
+    /**
+     * @brief Accesses a pixel.
+     * @param column The column of the pixel.
+     * @param row The row of the pixel.
+     * @return A const reference to the pixel.
+     */
+    const vec3& operator ()(unsigned int column, unsigned int row) const;
+
+    /**
+     * @brief Gives the contiguous pixels of a row.
+     * @param row The index of the row.
+     * @return The span of the width pixels of the row.
+     */
+    std::span<vec3> get_row(unsigned int row);
+
+    /**
+     * @brief Gives the contiguous pixels of a row.
+     * @param row The index of the row.
+     * @return The span of the width pixels of the row.
+     */
+    std::span<const vec3> get_row(unsigned int row) const;
 
-    const vec3& operator()(unsigned int row, unsigned int column) const;
+    /**
+     * @brief Gives the contiguous pixels of a tile's row.
+     * @param tile The tile.
+     * @param row The index of the row in the image, between tile.y_min and tile.y_max.
+     * @return The span of the pixels of the row between tile.x_min and tile.x_max.
+     */
+    std::span<vec3> get_tile_row(const Tile& tile, unsigned int row);
 
-    void write() const;
+    /**
+     * @brief Writes the pixels in a file of the format given by its extension. PNG files hold the
+     * pixels quantised to 8 bits, while PFM and HDR files keep their linear values above 1.
+     * @param path The path of the file.
+     */
+    void write(const std::string& path) const;
 
     const unsigned int width;
     const unsigned int height;
-    vec3** data;
-};
\ No newline at end of file
+    vec3* data;
+};
@@ -0,0 +1,73 @@
+/***************************************************************************************************
+ * @file  ImageWriter.hpp
+ * @brief Declaration of the ImageWriter class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Image.hpp"
+
+/**
+ * @class ImageWriter
+ * @brief Quantises and encodes finished images on a background thread so that rendering can go on
+ * while the previous frames are being written. The number of images waiting to be written is
+ * bounded, which caps the memory used by the queue.
+ */
+class ImageWriter {
+public:
+    /**
+     * @brief Constructs an image writer and starts its thread.
+     * @param max_queued The maximum number of images waiting to be written.
+     */
+    explicit ImageWriter(std::size_t max_queued = 2);
+
+    /**
+     * @brief Writes the remaining images then stops the thread.
+     */
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator =(const ImageWriter&) = delete;
+
+    /**
+     * @brief Hands an image over to the writer. Blocks while the queue is full. If a previous
+     * write failed, its exception is rethrown here.
+     * @param image The image to write.
+     * @param path The path of the file to write to.
+     */
+    void submit(Image&& image, std::string path);
+
+    /**
+     * @brief Waits until all the submitted images are written. If a write failed, its exception
+     * is rethrown here.
+     */
+    void wait();
+
+private:
+    struct Job {
+        Image image;
+        std::string path;
+    };
+
+    void writer_loop();
+
+    void rethrow_exception();
+
+    std::size_t max_queued;
+    std::deque<Job> queue;
+    bool writing;
+    bool stopping;
+    std::exception_ptr exception;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+};
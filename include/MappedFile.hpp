@@ -0,0 +1,58 @@
+/***************************************************************************************************
+ * @file  MappedFile.hpp
+ * @brief Declaration of the MappedFile class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+/**
+ * @class MappedFile
+ * @brief A file mapped read-only in memory. Its pages are read on demand by the kernel, so loaders
+ * can parse it in place from several threads without reading it into a buffer first.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps a whole file.
+     * @param path The path of the file.
+     */
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    /**
+     * @brief Takes ownership of another file's mapping, leaving it empty.
+     * @param file The file to move from.
+     */
+    MappedFile(MappedFile&& file) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator =(const MappedFile&) = delete;
+
+    /**
+     * @brief Gives the bytes of the file.
+     * @return The span of the bytes, empty for an empty file.
+     */
+    std::span<const std::byte> get_bytes() const;
+
+    /**
+     * @brief Gives the contents of the file as text.
+     * @return The view of the characters, empty for an empty file.
+     */
+    std::string_view get_text() const;
+
+    /**
+     * @brief Gives the size of the file.
+     * @return The size in bytes.
+     */
+    std::size_t get_size() const;
+
+private:
+    const char* data;
+    std::size_t size;
+};
@@ -0,0 +1,16 @@
+/***************************************************************************************************
+ * @file  Material.hpp
+ * @brief Declaration of the Material struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include "maths/vec3.hpp"
+
+/**
+ * @struct Material
+ * @brief How a surface looks. The surfaces are shaded with their normals, tinted by their albedo.
+ */
+struct Material {
+    vec3 albedo = vec3(1.0f); ///< The color of the surface.
+};
@@ -0,0 +1,126 @@
+/***************************************************************************************************
+ * @file  Profiler.hpp
+ * @brief Declaration of the Profiler struct and of the profiling macros
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+/**
+ * @struct Profiler
+ * @brief Per-thread hot path counters and phase timers, aggregated over all threads on demand.
+ * They are meant to be used through the PROFILE_* macros, which compile to nothing unless the
+ * PROFILING option is enabled.
+ */
+struct Profiler {
+    /**
+     * @brief The counted events.
+     */
+    enum Counter : unsigned int {
+        RAYS_CAST,
+        INTERSECTIONS_TESTED,
+        PIXELS_SHADED,
+        COUNTER_COUNT
+    };
+
+    /**
+     * @brief The timed phases of a render.
+     */
+    enum Phase : unsigned int {
+        SETUP,
+        RENDER,
+        QUANTISE,
+        ENCODE,
+        PHASE_COUNT
+    };
+
+    /**
+     * @struct ThreadData
+     * @brief The counters and timers of one thread. Only their thread writes them, and they fill
+     * whole cache lines so that the writes of a thread never invalidate the lines of another.
+     */
+    struct alignas(64) ThreadData {
+        std::atomic<std::uint64_t> counters[COUNTER_COUNT];
+        std::atomic<std::uint64_t> phase_nanoseconds[PHASE_COUNT];
+    };
+
+    /**
+     * @class ScopedTimer
+     * @brief Adds the time spent in its scope to a phase of the current thread.
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Phase phase);
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator =(const ScopedTimer&) = delete;
+
+    private:
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * @brief Adds an amount to a counter of the current thread.
+     * @param counter The counter.
+     * @param amount The amount to add.
+     */
+    static void count(Counter counter, std::uint64_t amount);
+
+    /**
+     * @brief Resets the counters and timers of every thread.
+     */
+    static void reset();
+
+    /**
+     * @brief Writes the counters and timers, summed over every thread, as JSON.
+     * @param stream The output stream to write to.
+     */
+    static void write_report(std::ostream& stream);
+
+    /**
+     * @brief Gives the data of the current thread, registering it on first use.
+     * @return The data of the current thread.
+     */
+    static ThreadData& get_thread_data();
+};
+
+/* ---- Implementation ---- */
+
+inline void Profiler::count(Counter counter, std::uint64_t amount) {
+    std::atomic<std::uint64_t>& value = get_thread_data().counters[counter];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline Profiler::ScopedTimer::ScopedTimer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) { }
+
+inline Profiler::ScopedTimer::~ScopedTimer() {
+    std::uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    std::atomic<std::uint64_t>& value = get_thread_data().phase_nanoseconds[phase];
+    value.store(value.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+}
+
+/* ---- Macros ---- */
+
+#ifdef PROFILING
+#define PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_IMPL(a, b)
+
+#define PROFILE_COUNT(counter, amount) Profiler::count(Profiler::counter, amount)
+#define PROFILE_PHASE(phase) Profiler::ScopedTimer PROFILE_CONCATENATE(profile_timer_, __LINE__)(Profiler::phase)
+#define PROFILE_RESET() Profiler::reset()
+#define PROFILE_REPORT(stream) Profiler::write_report(stream)
+#else
+#define PROFILE_COUNT(counter, amount) ((void) 0)
+#define PROFILE_PHASE(phase) ((void) 0)
+#define PROFILE_RESET() ((void) 0)
+#define PROFILE_REPORT(stream) ((void) 0)
+#endif
@@ -1,10 +1,11 @@
 /***************************************************************************************************
  * @file  Ray.hpp
- * @brief Declaration of the Ray struct
+ * @brief Definition of the Ray struct
  **************************************************************************************************/
 
 #pragma once
 
+#include "maths/geometry.hpp"
 #include "maths/vec3.hpp"
 
 /**
@@ -13,10 +14,18 @@
  */
 struct Ray {
     Ray() = default;
-    Ray(const vec3& origin, const vec3& direction);
+    inline Ray(const vec3& origin, const vec3& direction);
 
-    vec3 at(float distance) const;
+    constexpr vec3 at(float distance) const;
 
     vec3 origin;
     vec3 direction;
 };
+
+/* ---- Implementation ---- */
+
+inline Ray::Ray(const vec3& origin, const vec3& direction): origin(origin), direction(normalize(direction)) { }
+
+constexpr vec3 Ray::at(float distance) const {
+    return origin + distance * direction;
+}
@@ -0,0 +1,39 @@
+/***************************************************************************************************
+ * @file  RayPacket.hpp
+ * @brief Declaration of the RayPacket8 struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include "Ray.hpp"
+
+/**
+ * @struct RayPacket8
+ * @brief Holds 8 rays as a structure of arrays so that each component of the 8 rays can be loaded
+ * into a single AVX register.
+ */
+struct alignas(32) RayPacket8 {
+    static constexpr unsigned int size = 8; ///< The number of rays in the packet.
+
+    /**
+     * @brief Gives one of the rays of the packet.
+     * @param lane The index of the ray in the packet.
+     * @return The ray.
+     */
+    Ray get_ray(unsigned int lane) const;
+
+    /**
+     * @brief Replaces one of the rays of the packet.
+     * @param lane The index of the ray in the packet.
+     * @param ray The ray, its direction must already be normalized.
+     */
+    void set_ray(unsigned int lane, const Ray& ray);
+
+    float origin_x[size];    ///< The x components of the origins.
+    float origin_y[size];    ///< The y components of the origins.
+    float origin_z[size];    ///< The z components of the origins.
+    float direction_x[size]; ///< The x components of the normalized directions.
+    float direction_y[size]; ///< The y components of the normalized directions.
+    float direction_z[size]; ///< The z components of the normalized directions.
+};
+
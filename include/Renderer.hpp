@@ -0,0 +1,47 @@
+/***************************************************************************************************
+ * @file  Renderer.hpp
+ * @brief Declaration of the Renderer class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <functional>
+
+#include "Image.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @class Renderer
+ * @brief Splits an image into tiles and shades them on the workers of a thread pool.
+ */
+class Renderer {
+public:
+    /**
+     * @brief Constructs a renderer.
+     * @param pool The thread pool that schedules the tiles.
+     * @param tile_size The width and height of a tile in pixels.
+     */
+    explicit Renderer(ThreadPool& pool, unsigned int tile_size = 32);
+
+    /**
+     * @brief Shades every tile of an image. Each tile is handed to exactly one worker so the
+     * shading function can write the pixels of its tile without any synchronization. Tiles that
+     * take longer to shade are balanced by work stealing.
+     * @param image The image to render.
+     * @param shade_tile The function that shades all the pixels of a tile.
+     */
+    void render(Image& image, const std::function<void(const Tile&)>& shade_tile) const;
+
+    /**
+     * @brief Renders a scene. Every pixel is the average of scene.samples samples placed on a
+     * Hammersley point set, the first sample being the pixel's corner.
+     * @param scene The scene to render.
+     * @param image The image to render to, its size must be the scene's resolution.
+     */
+    void render(const Scene& scene, Image& image) const;
+
+private:
+    ThreadPool& pool;
+    unsigned int tile_size;
+};
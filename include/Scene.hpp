@@ -0,0 +1,36 @@
+/***************************************************************************************************
+ * @file  Scene.hpp
+ * @brief Declaration of the Scene struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Camera.hpp"
+#include "Material.hpp"
+#include "primitives/InstanceSet.hpp"
+#include "primitives/SphereSet.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @struct Scene
+ * @brief Everything needed to render a frame.
+ */
+struct Scene {
+    unsigned int width;   ///< The width of the image in pixels.
+    unsigned int height;  ///< The height of the image in pixels.
+    unsigned int samples; ///< The number of samples per pixel.
+
+    Camera camera; ///< The camera.
+
+    SphereSet spheres{};                ///< The spheres of the scene.
+    std::vector<TriangleMesh> meshes{}; ///< The triangle meshes of the scene.
+    InstanceSet instances{};            ///< The instanced triangle meshes of the scene.
+
+    std::vector<Material> materials{};     ///< The materials of the primitives, white for the primitives with none.
+    vec3 sky_bottom = vec3(1.0f);          ///< The color of the sky looking straight down.
+    vec3 sky_top = vec3(0.5f, 0.7f, 1.0f); ///< The color of the sky looking straight up.
+    std::string output = "data/img.png";   ///< The path of the rendered image.
+};
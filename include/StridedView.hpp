@@ -0,0 +1,82 @@
+/***************************************************************************************************
+ * @file  StridedView.hpp
+ * @brief Definition of the StridedView class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @class StridedView
+ * @brief A read-only view of values laid out at a fixed stride in memory, such as a field of an
+ * array of records. The values need not be aligned, so they are copied out when accessed.
+ * @tparam T The type of the values, which must be trivially copyable.
+ */
+template<typename T>
+class StridedView {
+    static_assert(std::is_trivially_copyable_v<T>, "The values of a StridedView are copied out of memory");
+
+public:
+    /**
+     * @brief Constructs an empty view.
+     */
+    constexpr StridedView() = default;
+
+    /**
+     * @brief Constructs a view.
+     * @param data The first byte of the first value.
+     * @param stride The number of bytes between the first bytes of two consecutive values.
+     * @param size The number of values.
+     */
+    constexpr StridedView(const std::byte* data, std::size_t stride, std::size_t size);
+
+    /**
+     * @brief Gives a value.
+     * @param index The index of the value.
+     * @return A copy of the value.
+     */
+    T operator [](std::size_t index) const;
+
+    /**
+     * @brief Gives the number of values.
+     * @return The number of values.
+     */
+    constexpr std::size_t size() const;
+
+    /**
+     * @brief Tests if the view has no values.
+     * @return Whether the view is empty.
+     */
+    constexpr bool empty() const;
+
+private:
+    const std::byte* data = nullptr;
+    std::size_t stride = 0;
+    std::size_t count = 0;
+};
+
+/* ---- Implementation ---- */
+
+template<typename T>
+constexpr StridedView<T>::StridedView(const std::byte* data, std::size_t stride, std::size_t size)
+    : data(data), stride(stride), count(size) { }
+
+template<typename T>
+T StridedView<T>::operator[](std::size_t index) const {
+    T value;
+    std::memcpy(&value, data + index * stride, sizeof(T));
+    return value;
+}
+
+template<typename T>
+constexpr std::size_t StridedView<T>::size() const {
+    return count;
+}
+
+template<typename T>
+constexpr bool StridedView<T>::empty() const {
+    return count == 0;
+}
@@ -0,0 +1,158 @@
+/***************************************************************************************************
+ * @file  ThreadPool.hpp
+ * @brief Declaration of the ThreadPool class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief A work-stealing thread pool. Every worker owns a deque of tasks: it pops its own tasks
+ * from the back and, once its deque is empty, steals tasks from the front of the other workers'
+ * deques.
+ */
+class ThreadPool {
+public:
+    /**
+     * @struct WorkerStats
+     * @brief Utilisation counters of a worker since the last call to reset_stats.
+     */
+    struct WorkerStats {
+        std::uint64_t tasks_executed; ///< The number of tasks the worker executed.
+        std::uint64_t tasks_stolen;   ///< How many of these tasks were stolen from another worker.
+        double busy_time;             ///< The time spent executing tasks, in seconds.
+        double utilisation;           ///< The ratio of busy time to the time elapsed.
+    };
+
+    /**
+     * @class TaskGroup
+     * @brief A set of tasks submitted to a pool that can be waited on independently of the other
+     * tasks of the pool, including from one of its tasks: a worker that waits on a group runs other
+     * tasks of the pool until the group is done, so groups can be nested for recursive parallelism.
+     */
+    class TaskGroup {
+    public:
+        /**
+         * @brief Constructs an empty group.
+         * @param pool The pool that runs the tasks of the group.
+         */
+        explicit TaskGroup(ThreadPool& pool);
+
+        /**
+         * @brief Waits for the tasks of the group to finish, ignoring their exceptions.
+         */
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator =(const TaskGroup&) = delete;
+
+        /**
+         * @brief Submits a task to the pool as part of the group.
+         * @param task The task to execute.
+         */
+        void submit(std::function<void()> task);
+
+        /**
+         * @brief Waits until all the tasks of the group are done, running other tasks of the pool
+         * meanwhile when called from one of its workers. If a task of the group threw an exception,
+         * the first one is rethrown here.
+         */
+        void wait();
+
+    private:
+        void wait_for_tasks();
+
+        ThreadPool& pool;
+        std::atomic<std::size_t> pending;
+
+        std::mutex mutex;
+        std::condition_variable done_condition;
+        std::exception_ptr exception;
+    };
+
+    /**
+     * @brief Constructs a thread pool and starts its workers.
+     * @param thread_count The number of worker threads.
+     */
+    explicit ThreadPool(unsigned int thread_count = std::thread::hardware_concurrency());
+
+    /**
+     * @brief Waits for all the submitted tasks to finish then stops the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator =(const ThreadPool&) = delete;
+
+    /**
+     * @brief Submits a task. When called from a worker, the task is pushed onto that worker's
+     * deque, otherwise the tasks are spread over the workers in a round-robin fashion.
+     * @param task The task to execute.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Waits until all the submitted tasks are done. Must not be called from a task of this
+     * pool, which should wait on a TaskGroup instead. If a task threw an exception, the first one is
+     * rethrown here.
+     */
+    void wait();
+
+    /**
+     * @brief Gives the number of workers.
+     * @return The number of worker threads.
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Gives the utilisation counters of every worker.
+     * @return The counters, indexed by worker.
+     */
+    std::vector<WorkerStats> get_stats() const;
+
+    /**
+     * @brief Resets the utilisation counters of every worker.
+     */
+    void reset_stats();
+
+private:
+    struct Worker {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+
+        std::atomic<std::uint64_t> tasks_executed;
+        std::atomic<std::uint64_t> tasks_stolen;
+        std::atomic<std::uint64_t> busy_nanoseconds;
+    };
+
+    void worker_loop(unsigned int index);
+
+    bool try_run_task(unsigned int index);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::atomic<std::size_t> queued;
+    std::atomic<std::size_t> pending;
+    std::atomic<unsigned int> next_worker;
+    bool stopping;
+
+    std::mutex mutex;
+    std::condition_variable wake_condition;
+    std::condition_variable done_condition;
+
+    std::exception_ptr exception;
+    std::chrono::steady_clock::time_point stats_start;
+};
@@ -0,0 +1,105 @@
+/***************************************************************************************************
+ * @file  AABB.hpp
+ * @brief Definition of the AABB struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include <limits>
+
+#include "maths/geometry.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @struct AABB
+ * @brief An axis-aligned bounding box. A default constructed box is empty: its minimum is +inf and
+ * its maximum -inf, so growing it by anything gives that thing's bounds.
+ */
+struct AABB {
+    /**
+     * @brief Constructs an empty box.
+     */
+    constexpr AABB();
+
+    /**
+     * @brief Constructs a box from its corners.
+     * @param min The corner with the smallest coordinates.
+     * @param max The corner with the largest coordinates.
+     */
+    constexpr AABB(const vec3& min, const vec3& max);
+
+    /**
+     * @brief Grows the box so that it contains a point.
+     * @param point The point.
+     */
+    constexpr void grow(const vec3& point);
+
+    /**
+     * @brief Grows the box so that it contains an other box.
+     * @param box The other box.
+     */
+    constexpr void grow(const AABB& box);
+
+    /**
+     * @brief Tests if the box contains nothing.
+     * @return Whether the box is empty.
+     */
+    constexpr bool is_empty() const;
+
+    /**
+     * @brief Gives the center of the box.
+     * @return The center.
+     */
+    constexpr vec3 get_center() const;
+
+    /**
+     * @brief Gives the size of the box along each axis.
+     * @return The size.
+     */
+    constexpr vec3 get_extent() const;
+
+    /**
+     * @brief Gives the surface area of the box, 0 if it is empty.
+     * @return The surface area.
+     */
+    constexpr float get_surface_area() const;
+
+    vec3 min; ///< The corner with the smallest coordinates.
+    vec3 max; ///< The corner with the largest coordinates.
+};
+
+/* ---- Implementation ---- */
+
+constexpr AABB::AABB()
+    : min(std::numeric_limits<float>::infinity()), max(-std::numeric_limits<float>::infinity()) { }
+
+constexpr AABB::AABB(const vec3& min, const vec3& max) : min(min), max(max) { }
+
+constexpr void AABB::grow(const vec3& point) {
+    min = ::min(min, point);
+    max = ::max(max, point);
+}
+
+constexpr void AABB::grow(const AABB& box) {
+    min = ::min(min, box.min);
+    max = ::max(max, box.max);
+}
+
+constexpr bool AABB::is_empty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+constexpr vec3 AABB::get_center() const {
+    return 0.5f * (min + max);
+}
+
+constexpr vec3 AABB::get_extent() const {
+    return max - min;
+}
+
+constexpr float AABB::get_surface_area() const {
+    if(is_empty()) { return 0.0f; }
+
+    vec3 extent = get_extent();
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
@@ -0,0 +1,432 @@
+/***************************************************************************************************
+ * @file  BVH.hpp
+ * @brief Declaration of the BVH class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Hit.hpp"
+#include "Profiler.hpp"
+#include "Ray.hpp"
+#include "ThreadPool.hpp"
+#include "acceleration/AABB.hpp"
+#include "acceleration/TraversalRay.hpp"
+#include "maths/vec3.hpp"
+
+class CacheReader;
+class CacheWriter;
+
+/**
+ * @class BVH
+ * @brief A bounding volume hierarchy over the bounding boxes of a set of primitives, built top-down
+ * with a binned surface area heuristic, or in linear time from the Morton codes of the centroids of
+ * the primitives when build speed matters more than traversal speed. It only stores primitive
+ * indices: the traversal calls back the owner of the primitives to intersect them. The hierarchy is
+ * a single array of 32 bytes nodes in depth-first order, with the primitive indices of the leaves
+ * packed in between.
+ */
+class BVH {
+public:
+    /**
+     * @struct Node
+     * @brief A slot of the node array, half a cache line. The first child of an inner node is the
+     * next slot, so only the second one is stored, and the children are on both sides of a plane
+     * along the split axis kept in the count. A leaf stores its first primitive index and is
+     * followed by as many slots as needed to hold the others, 8 per slot.
+     */
+    struct alignas(32) Node {
+        static constexpr std::uint32_t inner_flag = 1u << 31; ///< Set in the count of an inner node.
+
+        /**
+         * @brief Tests if the node is a leaf.
+         * @return Whether the node is a leaf.
+         */
+        bool is_leaf() const { return count < inner_flag; }
+
+        /**
+         * @brief Gives the axis an inner node is split along, its first child being the lower one.
+         * @return The axis.
+         */
+        unsigned int get_axis() const { return count & 3; }
+
+        /**
+         * @brief Gives the number of slots following a leaf that hold its primitive indices.
+         * @param count The number of primitives of the leaf.
+         * @return The number of slots.
+         */
+        static std::uint32_t get_index_slot_count(std::uint32_t count) { return count > 1 ? (count + 6) / 8 : 0; }
+
+        union {
+            struct {
+                float min[3];         ///< The smallest coordinates of the bounds of the node.
+                std::uint32_t offset; ///< The second child of an inner node, the first primitive of a leaf.
+                float max[3];         ///< The largest coordinates of the bounds of the node.
+                std::uint32_t count;  ///< The number of primitives of a leaf, the inner flag and split axis of an inner node.
+            };
+
+            std::uint32_t primitives[8]; ///< The primitive indices held by a slot following a leaf.
+        };
+    };
+
+    /**
+     * @enum Builder
+     * @brief The algorithms building a hierarchy.
+     */
+    enum class Builder {
+        SAH,   ///< Top-down binned SAH splits, slower to build but faster to traverse.
+        Morton ///< Centroids sorted along a Morton curve then split at their highest differing bit, for per-frame rebuilds.
+    };
+
+    static constexpr unsigned int bin_count = 16;     ///< The number of bins per axis.
+    static constexpr unsigned int max_leaf_size = 8;  ///< Bigger nodes are always split.
+    static constexpr unsigned int max_depth = 64;     ///< The depth of the traversal stack.
+    static constexpr float traversal_cost = 1.0f;     ///< The SAH cost of visiting a node.
+    static constexpr float intersection_cost = 1.0f;  ///< The SAH cost of testing a primitive.
+    static constexpr float rebuild_threshold = 1.5f;  ///< How much a refit may degrade the SAH cost before a rebuild.
+
+    /**
+     * @brief Constructs an empty hierarchy, which no ray hits.
+     */
+    BVH() = default;
+
+    /**
+     * @brief Builds the hierarchy of a set of primitives.
+     * @param primitive_bounds The bounds of every primitive.
+     * @param builder The algorithm building the hierarchy, also used by the rebuilds of refit.
+     */
+    explicit BVH(std::span<const AABB> primitive_bounds, Builder builder = Builder::SAH);
+
+    /**
+     * @brief Builds the hierarchy of a set of primitives in parallel: the top nodes are binned and
+     * partitioned, or the Morton codes sorted, by several tasks and the subtrees are built
+     * concurrently. Gives the same hierarchy as the serial build, up to the order of the nodes and
+     * of the primitives in a leaf.
+     * @param primitive_bounds The bounds of every primitive.
+     * @param pool The pool running the build.
+     * @param builder The algorithm building the hierarchy, also used by the rebuilds of refit.
+     */
+    BVH(std::span<const AABB> primitive_bounds, ThreadPool& pool, Builder builder = Builder::SAH);
+
+    /**
+     * @brief Reads a hierarchy written in a cache.
+     * @param reader The reader of the cache, whose contents must describe a valid hierarchy or a
+     * std::runtime_error is thrown.
+     * @param primitive_count The number of primitives the hierarchy must have been built for.
+     */
+    BVH(CacheReader& reader, std::uint32_t primitive_count);
+
+    /**
+     * @brief Writes the hierarchy in a cache, as it is laid out in memory.
+     * @param writer The writer of the cache.
+     */
+    void save(CacheWriter& writer) const;
+
+    /**
+     * @brief Updates the hierarchy to new bounds of the same primitives. Its topology is kept and
+     * the bounds of the nodes are recomputed bottom-up, unless this makes the SAH cost grow past
+     * rebuild_threshold times the cost of the last build, in which case it is rebuilt.
+     * @param primitive_bounds The new bounds of every primitive.
+     * @return Whether the hierarchy was rebuilt.
+     */
+    bool refit(std::span<const AABB> primitive_bounds);
+
+    /**
+     * @brief Updates the hierarchy to new bounds of the same primitives in parallel, the subtrees
+     * being refitted concurrently. Falls back to a parallel rebuild like the serial version.
+     * @param primitive_bounds The new bounds of every primitive.
+     * @param pool The pool running the update.
+     * @return Whether the hierarchy was rebuilt.
+     */
+    bool refit(std::span<const AABB> primitive_bounds, ThreadPool& pool);
+
+    /**
+     * @brief Finds the closest primitive hit by a ray, visiting first the child on the side of the
+     * split plane the ray comes from.
+     * @tparam IntersectPrimitive Callable as bool(std::uint32_t primitive, const Ray&, Hit&), that
+     * updates the hit when the primitive is hit closer and returns whether it did.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer primitive is hit.
+     * @param intersect_primitive The intersection routine of a single primitive.
+     * @return Whether a closer primitive was hit.
+     */
+    template<typename IntersectPrimitive>
+    bool intersect(const Ray& ray, Hit& hit, IntersectPrimitive&& intersect_primitive) const;
+
+    /**
+     * @brief Tests if a ray hits any primitive before a given distance and stops at the first one.
+     * @tparam IntersectPrimitive Callable as bool(std::uint32_t primitive, const Ray&, Hit&).
+     * @param ray The ray.
+     * @param max_distance The distance after which hits are ignored.
+     * @param intersect_primitive The intersection routine of a single primitive.
+     * @return Whether a primitive was hit.
+     */
+    template<typename IntersectPrimitive>
+    bool occluded(const Ray& ray, float max_distance, IntersectPrimitive&& intersect_primitive) const;
+
+    /**
+     * @brief Gives the bounds of all the primitives.
+     * @return The bounds of the root, empty if there are no primitives.
+     */
+    AABB get_bounds() const;
+
+    /**
+     * @brief Gives the node array, the root being the first slot.
+     * @return The nodes and the primitive index slots.
+     */
+    const std::vector<Node>& get_nodes() const;
+
+    /**
+     * @brief Gives a primitive index of a leaf.
+     * @param leaf The index of the leaf in the node array.
+     * @param primitive The index of the primitive in the leaf, lower than its count.
+     * @return The primitive index.
+     */
+    std::uint32_t get_primitive(std::uint32_t leaf, std::uint32_t primitive) const;
+
+    /**
+     * @brief Calculates the SAH cost of the hierarchy, relative to the surface area of the root.
+     * A root without area, around points or primitives along a line, gives a cost of 0.
+     * @return The cost.
+     */
+    float get_sah_cost() const;
+
+private:
+    struct BuildContext;
+    struct BuildNode;
+
+    /**
+     * @brief Builds the hierarchy.
+     * @param primitive_bounds The bounds of every primitive.
+     * @param pool The pool running the build, nullptr for a serial build.
+     */
+    void build(std::span<const AABB> primitive_bounds, ThreadPool* pool);
+
+    /**
+     * @brief Builds a node and, recursively, its children.
+     * @param context The state of the build.
+     * @param node The index of the node.
+     * @param first The index of the first primitive index of the node.
+     * @param count The number of primitives of the node.
+     * @param depth The depth of the node.
+     * @param bounds The bounds of the primitives of the node.
+     * @param centroid_bounds The bounds of the centroids of the primitives of the node.
+     */
+    void build_node(BuildContext& context, std::uint32_t node, std::uint32_t first, std::uint32_t count,
+                    unsigned int depth, const AABB& bounds, const AABB& centroid_bounds);
+
+    /**
+     * @brief Builds the hierarchy from the Morton codes of the centroids of the primitives.
+     * @tparam MortonCode std::uint32_t for 30-bit codes, std::uint64_t for 63-bit codes.
+     * @param context The state of the build.
+     * @param centroid_bounds The bounds of the centroids of all the primitives.
+     */
+    template<typename MortonCode>
+    void build_morton(BuildContext& context, const AABB& centroid_bounds);
+
+    /**
+     * @brief Builds a node covering a range of primitives sorted by Morton code and, recursively,
+     * its children. Subtrees cheaper to test as a single leaf are collapsed into one.
+     * @tparam MortonCode std::uint32_t for 30-bit codes, std::uint64_t for 63-bit codes.
+     * @param context The state of the build.
+     * @param codes The sorted Morton codes of the primitives.
+     * @param node The index of the node.
+     * @param first The index of the first primitive of the node.
+     * @param last The index of the last primitive of the node.
+     * @param depth The depth of the node.
+     * @return The SAH cost of the subtree, not relative to the surface area of the root.
+     */
+    template<typename MortonCode>
+    float build_morton_node(BuildContext& context, std::span<const MortonCode> codes, std::uint32_t node,
+                            std::uint32_t first, std::uint32_t last, unsigned int depth);
+
+    /**
+     * @brief Checks that the nodes read from a cache form a hierarchy over the primitive count, in
+     * depth-first order and no deeper than the traversal stack, so that the traversal and the refit
+     * stay in bounds. Throws a std::runtime_error otherwise.
+     */
+    void validate() const;
+
+    /**
+     * @brief Refits the hierarchy, or rebuilds it if the refit degrades it too much.
+     * @param primitive_bounds The new bounds of every primitive.
+     * @param pool The pool running the update, nullptr for a serial update.
+     * @return Whether the hierarchy was rebuilt.
+     */
+    bool update(std::span<const AABB> primitive_bounds, ThreadPool* pool);
+
+    /**
+     * @brief Recomputes the bounds of a node after those of its children.
+     * @param primitive_bounds The new bounds of every primitive.
+     * @param pool The pool running the update, nullptr for a serial update.
+     * @param node The index of the node.
+     * @param end The index following the last slot of the subtree of the node.
+     * @return The SAH cost of the subtree, not relative to the surface area of the root.
+     */
+    float refit_node(std::span<const AABB> primitive_bounds, ThreadPool* pool, std::uint32_t node, std::uint32_t end);
+
+    /**
+     * @brief Calculates the SAH cost of a node alone.
+     * @param node The node.
+     * @return The cost, not relative to the surface area of the root.
+     */
+    static float get_node_cost(const Node& node);
+
+    /**
+     * @brief Writes a built node and, recursively, its children in depth-first order.
+     * @param context The state of the build.
+     * @param node The index of the built node.
+     * @param slot The index of the slot of the node in the node array.
+     */
+    void flatten(const BuildContext& context, std::uint32_t node, std::uint32_t slot);
+
+    /**
+     * @brief Gives the primitive indices of a leaf that follow it.
+     * @param leaf The index of the leaf in the node array.
+     * @return The second primitive index of the leaf, the others follow it.
+     */
+    inline const std::uint32_t* get_other_primitives(std::uint32_t leaf) const;
+
+    /**
+     * @brief Intersects a ray with the bounds of a node using the slab method.
+     * @param node The node.
+     * @param ray The ray.
+     * @param max_distance The distance after which the box is ignored.
+     * @return The distance at which the ray enters the box, or +inf if it misses it.
+     */
+    static inline float intersect_bounds(const Node& node, const TraversalRay& ray, float max_distance);
+
+    std::vector<Node> nodes;
+    Builder builder = Builder::SAH;    ///< The algorithm building the hierarchy.
+    std::uint32_t primitive_count = 0; ///< The number of primitives the hierarchy was built for.
+    float built_sah_cost = 0.0f;       ///< The SAH cost right after the last build.
+};
+
+/* ---- Implementation ---- */
+
+template<typename IntersectPrimitive>
+bool BVH::intersect(const Ray& ray, Hit& hit, IntersectPrimitive&& intersect_primitive) const {
+    if(nodes.empty()) { return false; }
+
+    const TraversalRay traversal_ray(ray);
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    /* Far children are pushed with their entry distance so that they are skipped once a closer hit
+     * is found */
+    std::pair<std::uint32_t, float> stack[max_depth];
+    unsigned int stack_size = 0;
+
+    std::uint32_t index = 0;
+    if(intersect_bounds(nodes[0], traversal_ray, hit.distance) == infinity) { return false; }
+
+    bool found = false;
+
+    while(true) {
+        const Node& node = nodes[index];
+
+        if(node.is_leaf()) {
+            PROFILE_COUNT(INTERSECTIONS_TESTED, node.count);
+
+            found |= intersect_primitive(node.offset, ray, hit);
+
+            const std::uint32_t* primitives = get_other_primitives(index);
+            for(std::uint32_t i = 0 ; i + 1 < node.count ; ++i) {
+                found |= intersect_primitive(primitives[i], ray, hit);
+            }
+        } else {
+            /* A ray going down the split axis reaches the upper child first */
+            const std::uint32_t children[2] = { index + 1, node.offset };
+            const unsigned int near_side = traversal_ray.sign[node.get_axis()];
+            const std::uint32_t near = children[near_side];
+            const std::uint32_t far = children[near_side ^ 1];
+            const float near_distance = intersect_bounds(nodes[near], traversal_ray, hit.distance);
+            const float far_distance = intersect_bounds(nodes[far], traversal_ray, hit.distance);
+
+            if(near_distance != infinity) {
+                if(far_distance != infinity) { stack[stack_size++] = { far, far_distance }; }
+
+                index = near;
+                continue;
+            }
+
+            if(far_distance != infinity) {
+                index = far;
+                continue;
+            }
+        }
+
+        do {
+            if(stack_size == 0) { return found; }
+            --stack_size;
+        } while(stack[stack_size].second >= hit.distance);
+
+        index = stack[stack_size].first;
+    }
+}
+
+template<typename IntersectPrimitive>
+bool BVH::occluded(const Ray& ray, float max_distance, IntersectPrimitive&& intersect_primitive) const {
+    if(nodes.empty()) { return false; }
+
+    const TraversalRay traversal_ray(ray, 0.0f, max_distance);
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    Hit hit;
+    hit.distance = max_distance;
+
+    /* Any hit will do, so the children are visited in order */
+    std::uint32_t stack[max_depth];
+    unsigned int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while(stack_size > 0) {
+        std::uint32_t index = stack[--stack_size];
+        const Node& node = nodes[index];
+        if(intersect_bounds(node, traversal_ray, max_distance) == infinity) { continue; }
+
+        if(node.is_leaf()) {
+            PROFILE_COUNT(INTERSECTIONS_TESTED, node.count);
+
+            if(intersect_primitive(node.offset, ray, hit)) { return true; }
+
+            const std::uint32_t* primitives = get_other_primitives(index);
+            for(std::uint32_t i = 0 ; i + 1 < node.count ; ++i) {
+                if(intersect_primitive(primitives[i], ray, hit)) { return true; }
+            }
+        } else {
+            stack[stack_size++] = node.offset;
+            stack[stack_size++] = index + 1;
+        }
+    }
+
+    return false;
+}
+
+inline const std::uint32_t* BVH::get_other_primitives(std::uint32_t leaf) const {
+    /* The index slots of a leaf are contiguous, so they are read as one array */
+    return reinterpret_cast<const std::uint32_t*>(nodes.data() + leaf + 1);
+}
+
+inline float BVH::intersect_bounds(const Node& node, const TraversalRay& ray, float max_distance) {
+    /* The sign of the direction picks the plane the ray enters each slab through */
+    const float* bounds[2] = { node.min, node.max };
+
+    float near_x = bounds[ray.sign[0]][0] * ray.inverse_direction[0] - ray.scaled_origin[0];
+    float far_x = bounds[ray.sign[0] ^ 1][0] * ray.inverse_direction[0] - ray.scaled_origin[0];
+    float near_y = bounds[ray.sign[1]][1] * ray.inverse_direction[1] - ray.scaled_origin[1];
+    float far_y = bounds[ray.sign[1] ^ 1][1] * ray.inverse_direction[1] - ray.scaled_origin[1];
+    float near_z = bounds[ray.sign[2]][2] * ray.inverse_direction[2] - ray.scaled_origin[2];
+    float far_z = bounds[ray.sign[2] ^ 1][2] * ray.inverse_direction[2] - ray.scaled_origin[2];
+
+    float entry = std::max({ near_x, near_y, near_z, ray.min_distance });
+    float exit = std::min({ far_x, far_y, far_z, max_distance, ray.max_distance });
+
+    return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+}
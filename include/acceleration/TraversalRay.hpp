@@ -0,0 +1,59 @@
+/***************************************************************************************************
+ * @file  TraversalRay.hpp
+ * @brief Definition of the TraversalRay struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "Ray.hpp"
+
+/**
+ * @struct TraversalRay
+ * @brief What the box tests of a ray need, computed once per traversal. A slab plane is then hit at
+ * bound * inverse_direction - scaled_origin, a single multiply-subtract, and the sign of each
+ * component of the direction tells which side of a box the ray enters through and which child of a
+ * split it reaches first.
+ */
+struct TraversalRay {
+    /**
+     * @brief Prepares the box tests of a ray.
+     * @param ray The ray.
+     * @param min_distance The distance before which boxes are ignored.
+     * @param max_distance The distance after which boxes are ignored.
+     */
+    inline explicit TraversalRay(const Ray& ray, float min_distance = 0.0f,
+                                 float max_distance = std::numeric_limits<float>::infinity());
+
+    float inverse_direction[3]; ///< The inverse of each component of the direction.
+    float scaled_origin[3];     ///< The origin multiplied by the inverse direction.
+    unsigned int sign[3];       ///< 1 for the axes the direction goes down, 0 otherwise.
+    float min_distance;         ///< The start of the interval hits are looked for in.
+    float max_distance;         ///< The end of the interval hits are looked for in.
+
+private:
+    /**
+     * @brief Inverts a component of the direction. A null component would give an infinite inverse,
+     * and a NaN once multiplied by a null origin, so it is replaced by a tiny one of the same sign.
+     * @param component The component.
+     * @return The finite inverse.
+     */
+    static inline float get_inverse(float component);
+};
+
+/* ---- Implementation ---- */
+
+inline TraversalRay::TraversalRay(const Ray& ray, float min_distance, float max_distance)
+    : inverse_direction{ get_inverse(ray.direction.x), get_inverse(ray.direction.y), get_inverse(ray.direction.z) },
+      scaled_origin{
+          ray.origin.x * inverse_direction[0], ray.origin.y * inverse_direction[1], ray.origin.z * inverse_direction[2]
+      },
+      sign{ std::signbit(inverse_direction[0]), std::signbit(inverse_direction[1]), std::signbit(inverse_direction[2]) },
+      min_distance(min_distance), max_distance(max_distance) { }
+
+inline float TraversalRay::get_inverse(float component) {
+    constexpr float min_component = 1e-18f;
+    return 1.0f / (std::abs(component) < min_component ? std::copysign(min_component, component) : component);
+}
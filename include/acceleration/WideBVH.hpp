@@ -0,0 +1,563 @@
+/***************************************************************************************************
+ * @file  WideBVH.hpp
+ * @brief Declaration of the WideBVH class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Hit.hpp"
+#include "Profiler.hpp"
+#include "Ray.hpp"
+#include "ThreadPool.hpp"
+#include "acceleration/AABB.hpp"
+#include "acceleration/BVH.hpp"
+#include "acceleration/TraversalRay.hpp"
+#include "cache/CacheReader.hpp"
+#include "cache/CacheWriter.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @brief The width of the hierarchies the primitives are traversed with: 8 children fill an AVX
+ * register, 4 an SSE one.
+ */
+#ifdef MATHS_SIMD_AVX2
+inline constexpr unsigned int wide_bvh_width = 8;
+#else
+inline constexpr unsigned int wide_bvh_width = 4;
+#endif
+
+/**
+ * @class WideBVH
+ * @brief A bounding volume hierarchy whose nodes have up to Width children, obtained by collapsing a
+ * binary BVH. The bounds of the children of a node are stored as a structure of arrays, so that a ray
+ * is tested against all of them with a single SIMD slab test, and the children it hits are visited
+ * from the closest to the farthest.
+ * @tparam Width The maximum number of children of a node, 4 or 8.
+ */
+template<unsigned int Width>
+class WideBVH {
+    static_assert(Width == 4 || Width == 8, "WideBVH nodes have 4 or 8 children");
+
+public:
+    /**
+     * @struct Node
+     * @brief A node and the bounds of its children. Unused children have empty bounds, which no ray
+     * hits.
+     */
+    struct alignas(Width * sizeof(float)) Node {
+        float bounds[6][Width];        ///< The smallest then the largest x, y and z of each child.
+        std::uint32_t children[Width]; ///< The node of an inner child, the first primitive of a leaf.
+        std::uint32_t counts[Width];   ///< The number of primitives of a leaf, 0 for an inner child.
+    };
+
+    /**
+     * @brief Constructs an empty hierarchy, which no ray hits.
+     */
+    WideBVH() = default;
+
+    /**
+     * @brief Collapses a binary hierarchy: every node repeatedly opens its inner child with the
+     * largest surface area until it has Width children or only leaves.
+     * @param bvh The binary hierarchy.
+     */
+    explicit WideBVH(const BVH& bvh);
+
+    /**
+     * @brief Reads a hierarchy written in a cache.
+     * @param reader The reader of the cache, whose contents must describe a valid hierarchy or a
+     * std::runtime_error is thrown.
+     * @param primitive_count The number of primitives the hierarchy was built for.
+     */
+    WideBVH(CacheReader& reader, std::uint32_t primitive_count);
+
+    /**
+     * @brief Writes the hierarchy in a cache, as it is laid out in memory.
+     * @param writer The writer of the cache.
+     */
+    void save(CacheWriter& writer) const;
+
+    /**
+     * @brief Recomputes the bounds of every child after the primitives moved, keeping the topology.
+     * The children of a node always come after it, so the nodes are refitted in reverse order.
+     * @param primitive_bounds The new bounds of the primitives, indexed as during the construction.
+     */
+    void refit(std::span<const AABB> primitive_bounds);
+
+    /**
+     * @brief Recomputes the bounds of every child after the primitives moved, keeping the topology.
+     * The subtrees of the top levels are refitted by separate tasks, every node after its children.
+     * @param primitive_bounds The new bounds of the primitives, indexed as during the construction.
+     * @param pool The pool running the refit.
+     */
+    void refit(std::span<const AABB> primitive_bounds, ThreadPool& pool);
+
+    /**
+     * @brief Finds the closest primitive hit by a ray, visiting the closest children first.
+     * @tparam IntersectPrimitive Callable as bool(std::uint32_t primitive, const Ray&, Hit&), that
+     * updates the hit when the primitive is hit closer and returns whether it did.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer primitive is hit.
+     * @param intersect_primitive The intersection routine of a single primitive.
+     * @return Whether a closer primitive was hit.
+     */
+    template<typename IntersectPrimitive>
+    bool intersect(const Ray& ray, Hit& hit, IntersectPrimitive&& intersect_primitive) const;
+
+    /**
+     * @brief Tests if a ray hits any primitive before a given distance and stops at the first one.
+     * @tparam IntersectPrimitive Callable as bool(std::uint32_t primitive, const Ray&, Hit&).
+     * @param ray The ray.
+     * @param max_distance The distance after which hits are ignored.
+     * @param intersect_primitive The intersection routine of a single primitive.
+     * @return Whether a primitive was hit.
+     */
+    template<typename IntersectPrimitive>
+    bool occluded(const Ray& ray, float max_distance, IntersectPrimitive&& intersect_primitive) const;
+
+    /**
+     * @brief Gives the nodes, the root being the first one.
+     * @return The nodes.
+     */
+    const std::vector<Node>& get_nodes() const;
+
+    /**
+     * @brief Gives the primitive indices the leaves refer to.
+     * @return The primitive indices.
+     */
+    const std::vector<std::uint32_t>& get_primitives() const;
+
+private:
+    /**
+     * @struct StackEntry
+     * @brief A child left to visit.
+     */
+    struct StackEntry {
+        std::uint32_t child; ///< The node of an inner child, the first primitive of a leaf.
+        std::uint32_t count; ///< The number of primitives of a leaf, 0 for an inner child.
+        float distance;      ///< The distance at which the ray enters the child.
+    };
+
+    static constexpr unsigned int max_stack_size = BVH::max_depth * Width; ///< Every level pushes at most Width - 1 children.
+    static constexpr unsigned int parallel_refit_depth = 2;               ///< Deeper subtrees are refitted in the task of their parent.
+
+    /**
+     * @brief Fills a node with the children of a binary node and, recursively, their own nodes.
+     * @param bvh The binary hierarchy.
+     * @param binary The index of the binary node.
+     * @param node The index of the node.
+     */
+    void collapse(const BVH& bvh, std::uint32_t binary, std::uint32_t node);
+
+    /**
+     * @brief Recomputes the bounds of a child from those of its own children or of its primitives.
+     * @param primitive_bounds The new bounds of the primitives.
+     * @param node The node.
+     * @param lane The child.
+     */
+    void refit_child(std::span<const AABB> primitive_bounds, Node& node, unsigned int lane);
+
+    /**
+     * @brief Refits a node after its inner children, recursively, which are refitted by separate
+     * tasks while the node is one of the top levels.
+     * @param primitive_bounds The new bounds of the primitives.
+     * @param pool The pool running the refit.
+     * @param index The index of the node.
+     * @param depth The depth of the node.
+     */
+    void refit_node(std::span<const AABB> primitive_bounds, ThreadPool& pool, std::uint32_t index, unsigned int depth);
+
+    /**
+     * @brief Intersects a ray with the bounds of every child of a node. The sign of each component
+     * of the direction selects the bounds the ray enters through, so that empty bounds give an
+     * infinite entry distance whatever the direction.
+     * @param node The node.
+     * @param ray The ray.
+     * @param max_distance The distance after which the children are ignored.
+     * @param distances Where the distance at which the ray enters each child is written.
+     * @return The mask of the children that are hit.
+     */
+    static inline unsigned int intersect_children(const Node& node, const TraversalRay& ray, float max_distance,
+                                                  float distances[Width]);
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> primitives;
+};
+
+/* ---- Implementation ---- */
+
+template<unsigned int Width>
+WideBVH<Width>::WideBVH(const BVH& bvh) {
+    if(bvh.get_nodes().empty()) { return; }
+
+    nodes.emplace_back();
+    collapse(bvh, 0, 0);
+}
+
+template<unsigned int Width>
+WideBVH<Width>::WideBVH(CacheReader& reader, std::uint32_t primitive_count) {
+    reader.read_array(nodes);
+    reader.read_array(primitives);
+
+    if(nodes.empty() != (primitive_count == 0) || primitives.size() != primitive_count) {
+        throw std::runtime_error("Failed to read a cached wide hierarchy, it does not match its primitive count");
+    }
+
+    for(std::uint32_t primitive : primitives) {
+        if(primitive >= primitive_count) {
+            throw std::runtime_error("Failed to read a cached wide hierarchy, a leaf refers to a missing primitive");
+        }
+    }
+
+    /* Every node but the root must be the child of a single earlier node, which bounds the depth
+     * like the traversal stack expects and keeps the reverse order of the refit valid */
+    std::vector<unsigned int> depths(nodes.size(), 0);
+    if(!nodes.empty()) { depths[0] = 1; }
+
+    for(std::size_t index = 0 ; index < nodes.size() ; ++index) {
+        if(depths[index] == 0) {
+            throw std::runtime_error("Failed to read a cached wide hierarchy, a node is unreachable");
+        }
+
+        const Node& node = nodes[index];
+        for(unsigned int lane = 0 ; lane < Width ; ++lane) {
+            const std::uint32_t child = node.children[lane];
+            const std::uint32_t count = node.counts[lane];
+
+            if(count > 0) {
+                if(child > primitives.size() || count > primitives.size() - child) {
+                    throw std::runtime_error("Failed to read a cached wide hierarchy, a leaf overflows the primitive array");
+                }
+            } else if(child != 0) {
+                if(child <= index || child >= nodes.size() || depths[child] != 0 || depths[index] >= BVH::max_depth) {
+                    throw std::runtime_error("Failed to read a cached wide hierarchy, a node has an invalid child");
+                }
+
+                depths[child] = depths[index] + 1;
+            }
+        }
+    }
+}
+
+template<unsigned int Width>
+void WideBVH<Width>::save(CacheWriter& writer) const {
+    writer.write_array(std::span<const Node>(nodes));
+    writer.write_array(std::span<const std::uint32_t>(primitives));
+}
+
+template<unsigned int Width>
+void WideBVH<Width>::refit(std::span<const AABB> primitive_bounds) {
+    for(std::size_t index = nodes.size() ; index-- > 0 ; ) {
+        for(unsigned int lane = 0 ; lane < Width ; ++lane) { refit_child(primitive_bounds, nodes[index], lane); }
+    }
+}
+
+template<unsigned int Width>
+void WideBVH<Width>::refit(std::span<const AABB> primitive_bounds, ThreadPool& pool) {
+    if(nodes.empty()) { return; }
+
+    refit_node(primitive_bounds, pool, 0, 0);
+}
+
+template<unsigned int Width>
+template<typename IntersectPrimitive>
+bool WideBVH<Width>::intersect(const Ray& ray, Hit& hit, IntersectPrimitive&& intersect_primitive) const {
+    if(nodes.empty()) { return false; }
+
+    const TraversalRay traversal_ray(ray);
+
+    StackEntry stack[max_stack_size];
+    unsigned int stack_size = 0;
+    std::uint32_t index = 0;
+    bool found = false;
+
+    while(true) {
+        alignas(32) float distances[Width];
+        unsigned int mask = intersect_children(nodes[index], traversal_ray, hit.distance, distances);
+
+        /* Push the children that are hit from the farthest to the closest, so that the closest is
+         * popped first */
+        const unsigned int first = stack_size;
+        for( ; mask != 0 ; mask &= mask - 1) {
+            unsigned int lane = std::countr_zero(mask);
+            StackEntry entry{ nodes[index].children[lane], nodes[index].counts[lane], distances[lane] };
+
+            unsigned int i = stack_size++;
+            for( ; i > first && stack[i - 1].distance < entry.distance ; --i) { stack[i] = stack[i - 1]; }
+            stack[i] = entry;
+        }
+
+        /* Visit the closest children until one is an inner node, skipping the ones that a hit found
+         * in the meantime is closer than */
+        while(true) {
+            if(stack_size == 0) { return found; }
+
+            const StackEntry& entry = stack[--stack_size];
+            if(entry.distance >= hit.distance) { continue; }
+            if(entry.count == 0) {
+                index = entry.child;
+                break;
+            }
+
+            PROFILE_COUNT(INTERSECTIONS_TESTED, entry.count);
+            for(std::uint32_t i = entry.child ; i < entry.child + entry.count ; ++i) {
+                found |= intersect_primitive(primitives[i], ray, hit);
+            }
+        }
+    }
+}
+
+template<unsigned int Width>
+template<typename IntersectPrimitive>
+bool WideBVH<Width>::occluded(const Ray& ray, float max_distance, IntersectPrimitive&& intersect_primitive) const {
+    if(nodes.empty()) { return false; }
+
+    const TraversalRay traversal_ray(ray, 0.0f, max_distance);
+
+    Hit hit;
+    hit.distance = max_distance;
+
+    /* Any hit will do, so the children are visited in order */
+    std::uint32_t stack[max_stack_size];
+    unsigned int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while(stack_size > 0) {
+        const Node& node = nodes[stack[--stack_size]];
+
+        alignas(32) float distances[Width];
+        for(unsigned int mask = intersect_children(node, traversal_ray, max_distance, distances) ; mask != 0 ; mask &= mask - 1) {
+            unsigned int lane = std::countr_zero(mask);
+
+            if(node.counts[lane] == 0) {
+                stack[stack_size++] = node.children[lane];
+                continue;
+            }
+
+            PROFILE_COUNT(INTERSECTIONS_TESTED, node.counts[lane]);
+            for(std::uint32_t i = node.children[lane] ; i < node.children[lane] + node.counts[lane] ; ++i) {
+                if(intersect_primitive(primitives[i], ray, hit)) { return true; }
+            }
+        }
+    }
+
+    return false;
+}
+
+template<unsigned int Width>
+const std::vector<typename WideBVH<Width>::Node>& WideBVH<Width>::get_nodes() const {
+    return nodes;
+}
+
+template<unsigned int Width>
+const std::vector<std::uint32_t>& WideBVH<Width>::get_primitives() const {
+    return primitives;
+}
+
+template<unsigned int Width>
+void WideBVH<Width>::refit_child(std::span<const AABB> primitive_bounds, Node& node, unsigned int lane) {
+    if(node.children[lane] == 0 && node.counts[lane] == 0) { return; }
+
+    AABB bounds;
+    if(node.counts[lane] == 0) {
+        const Node& child = nodes[node.children[lane]];
+        for(unsigned int child_lane = 0 ; child_lane < Width ; ++child_lane) {
+            bounds.grow(AABB(vec3(child.bounds[0][child_lane], child.bounds[1][child_lane], child.bounds[2][child_lane]),
+                             vec3(child.bounds[3][child_lane], child.bounds[4][child_lane], child.bounds[5][child_lane])));
+        }
+    } else {
+        for(std::uint32_t i = node.children[lane] ; i < node.children[lane] + node.counts[lane] ; ++i) {
+            bounds.grow(primitive_bounds[primitives[i]]);
+        }
+    }
+
+    node.bounds[0][lane] = bounds.min.x;
+    node.bounds[1][lane] = bounds.min.y;
+    node.bounds[2][lane] = bounds.min.z;
+    node.bounds[3][lane] = bounds.max.x;
+    node.bounds[4][lane] = bounds.max.y;
+    node.bounds[5][lane] = bounds.max.z;
+}
+
+template<unsigned int Width>
+void WideBVH<Width>::refit_node(std::span<const AABB> primitive_bounds, ThreadPool& pool, std::uint32_t index, unsigned int depth) {
+    Node& node = nodes[index];
+
+    if(depth < parallel_refit_depth) {
+        ThreadPool::TaskGroup group(pool);
+        for(unsigned int lane = 0 ; lane < Width ; ++lane) {
+            if(node.counts[lane] != 0 || node.children[lane] == 0) { continue; }
+            group.submit([&, lane] { refit_node(primitive_bounds, pool, node.children[lane], depth + 1); });
+        }
+        group.wait();
+    } else {
+        for(unsigned int lane = 0 ; lane < Width ; ++lane) {
+            if(node.counts[lane] != 0 || node.children[lane] == 0) { continue; }
+            refit_node(primitive_bounds, pool, node.children[lane], depth + 1);
+        }
+    }
+
+    for(unsigned int lane = 0 ; lane < Width ; ++lane) { refit_child(primitive_bounds, node, lane); }
+}
+
+template<unsigned int Width>
+void WideBVH<Width>::collapse(const BVH& bvh, std::uint32_t binary, std::uint32_t node) {
+    const std::vector<BVH::Node>& binary_nodes = bvh.get_nodes();
+
+    auto get_surface_area = [&binary_nodes](std::uint32_t index) {
+        const BVH::Node& binary_node = binary_nodes[index];
+        float x = binary_node.max[0] - binary_node.min[0];
+        float y = binary_node.max[1] - binary_node.min[1];
+        float z = binary_node.max[2] - binary_node.min[2];
+
+        return x * y + y * z + z * x;
+    };
+
+    /* A leaf root is the only child of the root */
+    std::uint32_t children[Width] = { binary };
+    unsigned int child_count = 1;
+
+    if(!binary_nodes[binary].is_leaf()) {
+        children[0] = binary + 1;
+        children[1] = binary_nodes[binary].offset;
+        child_count = 2;
+    }
+
+    while(child_count < Width) {
+        unsigned int largest = Width;
+        float largest_area = -1.0f;
+        for(unsigned int child = 0 ; child < child_count ; ++child) {
+            if(binary_nodes[children[child]].is_leaf()) { continue; }
+
+            float area = get_surface_area(children[child]);
+            if(area > largest_area) {
+                largest = child;
+                largest_area = area;
+            }
+        }
+
+        if(largest == Width) { break; }
+
+        std::uint32_t opened = children[largest];
+        children[largest] = opened + 1;
+        children[child_count++] = binary_nodes[opened].offset;
+    }
+
+    /* Children nodes are allocated before recursing, so that the siblings are contiguous */
+    Node filled;
+    std::uint32_t inner_children[Width];
+    unsigned int inner_count = 0;
+
+    for(unsigned int lane = 0 ; lane < Width ; ++lane) {
+        if(lane >= child_count) {
+            for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+                filled.bounds[axis][lane] = std::numeric_limits<float>::infinity();
+                filled.bounds[axis + 3][lane] = -std::numeric_limits<float>::infinity();
+            }
+            filled.children[lane] = 0;
+            filled.counts[lane] = 0;
+            continue;
+        }
+
+        const BVH::Node& child = binary_nodes[children[lane]];
+        for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+            filled.bounds[axis][lane] = child.min[axis];
+            filled.bounds[axis + 3][lane] = child.max[axis];
+        }
+
+        if(child.is_leaf()) {
+            filled.children[lane] = primitives.size();
+            filled.counts[lane] = child.count;
+            for(std::uint32_t i = 0 ; i < child.count ; ++i) {
+                primitives.push_back(bvh.get_primitive(children[lane], i));
+            }
+        } else {
+            filled.children[lane] = nodes.size();
+            filled.counts[lane] = 0;
+            inner_children[inner_count++] = children[lane];
+            nodes.emplace_back();
+        }
+    }
+
+    nodes[node] = filled;
+
+    for(unsigned int lane = 0, inner = 0 ; lane < child_count ; ++lane) {
+        if(filled.counts[lane] == 0) { collapse(bvh, inner_children[inner++], filled.children[lane]); }
+    }
+}
+
+template<unsigned int Width>
+inline unsigned int WideBVH<Width>::intersect_children(const Node& node, const TraversalRay& ray, float max_distance,
+                                                       float distances[Width]) {
+#ifdef MATHS_SIMD_AVX2
+    if constexpr(Width == 8) {
+        __m256 entry = _mm256_set1_ps(ray.min_distance);
+        __m256 exit = _mm256_set1_ps(std::min(max_distance, ray.max_distance));
+
+        for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+            const unsigned int sign = ray.sign[axis];
+            const __m256 inverse_direction = _mm256_set1_ps(ray.inverse_direction[axis]);
+            const __m256 scaled_origin = _mm256_set1_ps(ray.scaled_origin[axis]);
+
+            __m256 near = _mm256_fmsub_ps(_mm256_load_ps(node.bounds[axis + 3 * sign]), inverse_direction, scaled_origin);
+            __m256 far = _mm256_fmsub_ps(_mm256_load_ps(node.bounds[axis + 3 * (sign ^ 1)]), inverse_direction, scaled_origin);
+            entry = _mm256_max_ps(entry, near);
+            exit = _mm256_min_ps(exit, far);
+        }
+
+        _mm256_store_ps(distances, entry);
+        return _mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ));
+    }
+#endif
+
+#ifdef MATHS_SIMD_SSE4
+    if constexpr(Width == 4) {
+        __m128 entry = _mm_set1_ps(ray.min_distance);
+        __m128 exit = _mm_set1_ps(std::min(max_distance, ray.max_distance));
+
+        for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+            const unsigned int sign = ray.sign[axis];
+            const __m128 inverse_direction = _mm_set1_ps(ray.inverse_direction[axis]);
+            const __m128 scaled_origin = _mm_set1_ps(ray.scaled_origin[axis]);
+
+            __m128 near = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(node.bounds[axis + 3 * sign]), inverse_direction), scaled_origin);
+            __m128 far = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(node.bounds[axis + 3 * (sign ^ 1)]), inverse_direction), scaled_origin);
+            entry = _mm_max_ps(entry, near);
+            exit = _mm_min_ps(exit, far);
+        }
+
+        _mm_store_ps(distances, entry);
+        return _mm_movemask_ps(_mm_cmple_ps(entry, exit));
+    }
+#endif
+
+    unsigned int mask = 0;
+    for(unsigned int lane = 0 ; lane < Width ; ++lane) {
+        float entry = ray.min_distance;
+        float exit = std::min(max_distance, ray.max_distance);
+
+        for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+            const unsigned int sign = ray.sign[axis];
+            const float inverse_direction = ray.inverse_direction[axis];
+            const float scaled_origin = ray.scaled_origin[axis];
+
+            float near = node.bounds[axis + 3 * sign][lane] * inverse_direction - scaled_origin;
+            float far = node.bounds[axis + 3 * (sign ^ 1)][lane] * inverse_direction - scaled_origin;
+            entry = entry > near ? entry : near;
+            exit = exit < far ? exit : far;
+        }
+
+        distances[lane] = entry;
+        if(entry <= exit) { mask |= 1u << lane; }
+    }
+
+    return mask;
+}
@@ -0,0 +1,99 @@
+/***************************************************************************************************
+ * @file  CacheReader.hpp
+ * @brief Declaration of the CacheReader class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "cache/format.hpp"
+
+/**
+ * @class CacheReader
+ * @brief A cache file mapped in memory, from which objects read back their values and arrays in the
+ * order they wrote them. The file is checked when it is opened, so a reader never reads outside of
+ * it or from a file that was corrupted or built from other inputs.
+ */
+class CacheReader {
+public:
+    /**
+     * @brief Maps a cache file and checks its header and checksum.
+     * @param path The path of the file.
+     * @param key The hash of the inputs and settings the objects must have been built from.
+     */
+    CacheReader(const std::string& path, std::uint64_t key);
+
+    /**
+     * @brief Reads the next value of the table.
+     * @return The value.
+     */
+    template<typename T>
+    T read_value();
+
+    /**
+     * @brief Reads the next array of the table, in place.
+     * @return The span of the elements of the array, in the mapping.
+     */
+    template<typename T>
+    std::span<const T> read_array();
+
+    /**
+     * @brief Reads the next array of the table into a vector.
+     * @param values The vector, resized to the array.
+     */
+    template<typename T, typename Allocator>
+    void read_array(std::vector<T, Allocator>& values);
+
+private:
+    /**
+     * @brief Moves past the next bytes of the table.
+     * @param size The number of bytes.
+     * @return The first of the bytes.
+     */
+    const std::byte* consume(std::size_t size);
+
+    std::string path;
+    MappedFile file;
+    std::span<const std::byte> table;
+    std::span<const std::byte> data;
+    std::size_t cursor;
+};
+
+/* ---- Implementation ---- */
+
+template<typename T>
+T CacheReader::read_value() {
+    static_assert(std::is_trivially_copyable_v<T>, "Cached values are copied byte by byte");
+
+    T value;
+    std::memcpy(&value, consume(sizeof(T)), sizeof(T));
+    return value;
+}
+
+template<typename T>
+std::span<const T> CacheReader::read_array() {
+    static_assert(std::is_trivially_copyable_v<T>, "Cached arrays are copied byte by byte");
+
+    const CacheArray array = read_value<CacheArray>();
+    if(array.offset % alignof(T) != 0 || array.offset > data.size() || array.count > (data.size() - array.offset) / sizeof(T)) {
+        throw std::runtime_error("Failed to read an array of cache file '" + path + '\'');
+    }
+
+    /* The data section is aligned in the file, and the mapping on a page */
+    return { reinterpret_cast<const T*>(data.data() + array.offset), array.count };
+}
+
+template<typename T, typename Allocator>
+void CacheReader::read_array(std::vector<T, Allocator>& values) {
+    const std::span<const T> array = read_array<T>();
+    values.assign(array.begin(), array.end());
+}
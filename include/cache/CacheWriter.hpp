@@ -0,0 +1,73 @@
+/***************************************************************************************************
+ * @file  CacheWriter.hpp
+ * @brief Declaration of the CacheWriter class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "cache/format.hpp"
+
+/**
+ * @class CacheWriter
+ * @brief Lays objects out in memory as a cache file, then saves it. The objects write their values
+ * and arrays in an order that they read back from a CacheReader.
+ */
+class CacheWriter {
+public:
+    /**
+     * @brief Writes a value in the table.
+     * @param value The value, which must be trivially copyable.
+     */
+    template<typename T>
+    void write_value(const T& value);
+
+    /**
+     * @brief Writes an array in the data section, and its offset and size in the table.
+     * @param values The elements of the array, which must be trivially copyable.
+     */
+    template<typename T>
+    void write_array(std::span<const T> values);
+
+    /**
+     * @brief Saves the cache file. It is written next to its path then renamed, so that a reader
+     * never sees a partial file.
+     * @param path The path of the file.
+     * @param key The hash of the inputs and settings of the cached objects.
+     */
+    void save(const std::string& path, std::uint64_t key) const;
+
+private:
+    std::vector<std::byte> table;
+    std::vector<std::byte> data;
+};
+
+/* ---- Implementation ---- */
+
+template<typename T>
+void CacheWriter::write_value(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Cached values are copied byte by byte");
+
+    std::size_t offset = table.size();
+    table.resize(offset + sizeof(T));
+    std::memcpy(table.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+void CacheWriter::write_array(std::span<const T> values) {
+    static_assert(std::is_trivially_copyable_v<T>, "Cached arrays are copied byte by byte");
+    static_assert(alignof(T) <= cache_alignment, "Cached arrays are aligned to cache_alignment");
+
+    std::size_t offset = (data.size() + cache_alignment - 1) / cache_alignment * cache_alignment;
+    data.resize(offset + values.size_bytes());
+    if(!values.empty()) { std::memcpy(data.data() + offset, values.data(), values.size_bytes()); }
+
+    write_value(CacheArray{ offset, values.size() });
+}
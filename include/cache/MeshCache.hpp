@@ -0,0 +1,83 @@
+/***************************************************************************************************
+ * @file  MeshCache.hpp
+ * @brief Declaration of the MeshCache class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ThreadPool.hpp"
+#include "acceleration/BVH.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @class MeshCache
+ * @brief A directory of cache files holding meshes ready to be traced, with their triangle arrays
+ * and their BVHs. Every file is named after a hash of the contents of the mesh file it was built
+ * from and of the build settings, so an edited mesh file or a change of builder or of SIMD backend
+ * never reads a stale cache file.
+ */
+class MeshCache {
+public:
+    /**
+     * @brief Constructs a cache storing its files in a directory.
+     * @param directory The path of the directory, created if needed and if possible.
+     */
+    explicit MeshCache(std::string directory);
+
+    /**
+     * @brief Loads a mesh file and builds the BVH of the mesh, unless it was already done with the
+     * same settings, in which case the mesh is read back from its cache file. Otherwise, and if the
+     * cache file cannot be read, the mesh is written in its cache file once built; a cache file that
+     * cannot be written is skipped, the mesh being returned all the same.
+     * @param path The path of the mesh file.
+     * @param pool The pool loading the mesh file and building the BVH.
+     * @param builder The algorithm building the BVH.
+     * @return The mesh, with its BVH.
+     */
+    TriangleMesh load(const std::string& path, ThreadPool& pool, BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Gives the path of the cache file of a mesh file.
+     * @param path The path of the mesh file.
+     * @param builder The algorithm building the BVH.
+     * @return The path of the cache file, which may not exist.
+     */
+    std::string get_cache_path(const std::string& path, BVH::Builder builder) const;
+
+    /**
+     * @brief Gives the number of meshes read from their cache file.
+     * @return The number of hits.
+     */
+    std::size_t get_hit_count() const;
+
+    /**
+     * @brief Gives the number of meshes that were built then written in their cache file.
+     * @return The number of misses.
+     */
+    std::size_t get_miss_count() const;
+
+private:
+    /**
+     * @brief Hashes the contents and the format of a mesh file with the settings its cache file
+     * depends on.
+     * @param path The path of the mesh file.
+     * @param builder The algorithm building the BVH.
+     * @return The key of the cache file.
+     */
+    static std::uint64_t get_key(const std::string& path, BVH::Builder builder);
+
+    /**
+     * @brief Gives the path of the cache file of a key.
+     * @param key The key.
+     * @return The path of the cache file.
+     */
+    std::string get_cache_path(std::uint64_t key) const;
+
+    std::string directory;
+    std::size_t hit_count = 0;
+    std::size_t miss_count = 0;
+};
@@ -0,0 +1,96 @@
+/***************************************************************************************************
+ * @file  format.hpp
+ * @brief Definition of the layout of the cache files and of the hash keying them
+ **************************************************************************************************/
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+/**
+ * A cache file is a header followed by a table and a data section. The table holds the values in
+ * the order they were written, the arrays being replaced by their offset from the start of the data
+ * section and their size. The arrays are aligned in the data section as in memory, so the file can
+ * be mapped and the arrays read in place wherever the mapping lands.
+ */
+
+inline constexpr char cache_magic[8] = { 'R', 'T', 'C', 'A', 'C', 'H', 'E', '\0' }; ///< The first bytes of a cache file.
+inline constexpr std::uint32_t cache_version = 1;  ///< Changed whenever the layout of the cached objects changes.
+inline constexpr std::size_t cache_alignment = 64; ///< The alignment of the data section and of its arrays.
+
+/**
+ * @struct CacheHeader
+ * @brief The header of a cache file.
+ */
+struct CacheHeader {
+    char magic[8];             ///< Always cache_magic.
+    std::uint32_t version;     ///< The version of the layout, cache_version.
+    std::uint32_t header_size; ///< The size of the header, to catch a different ABI.
+    std::uint64_t key;         ///< The hash of the inputs and settings the cached objects were built from.
+    std::uint64_t checksum;    ///< The hash of the table and of the data section.
+    std::uint64_t table_size;  ///< The size of the table, which follows the header.
+    std::uint64_t data_offset; ///< The offset of the data section from the start of the file.
+    std::uint64_t data_size;   ///< The size of the data section.
+};
+
+/**
+ * @struct CacheArray
+ * @brief An array in the table of a cache file.
+ */
+struct CacheArray {
+    std::uint64_t offset; ///< The offset of the array from the start of the data section.
+    std::uint64_t count;  ///< The number of elements of the array.
+};
+
+/**
+ * @brief Hashes bytes. Four independent lanes take 8 bytes each at a time, so that hashing keeps up
+ * with reading the bytes from memory; the hash is not meant to resist attacks.
+ * @param bytes The bytes.
+ * @param seed The seed, which chains hashes.
+ * @return The hash.
+ */
+inline std::uint64_t hash_bytes(std::span<const std::byte> bytes, std::uint64_t seed = 0);
+
+/* ---- Implementation ---- */
+
+inline std::uint64_t hash_bytes(std::span<const std::byte> bytes, std::uint64_t seed) {
+    constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87;
+    constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4F;
+    constexpr std::uint64_t prime3 = 0x165667B19E3779F9;
+
+    auto round = [](std::uint64_t accumulator, std::uint64_t word) {
+        return std::rotl(accumulator + word * prime2, 31) * prime1;
+    };
+
+    auto load = [](const std::byte* data) {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        return word;
+    };
+
+    const std::byte* data = bytes.data();
+    const std::byte* end = data + bytes.size();
+
+    std::uint64_t lanes[4] = { seed + prime1 + prime2, seed + prime2, seed, seed - prime1 };
+    for( ; end - data >= 32 ; data += 32) {
+        for(int lane = 0 ; lane < 4 ; ++lane) { lanes[lane] = round(lanes[lane], load(data + 8 * lane)); }
+    }
+
+    std::uint64_t hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+    hash += bytes.size();
+
+    for( ; end - data >= 8 ; data += 8) { hash = std::rotl(hash ^ round(0, load(data)), 27) * prime1 + prime3; }
+    for( ; data != end ; ++data) { hash = std::rotl(hash ^ static_cast<std::uint64_t>(*data) * prime3, 11) * prime1; }
+
+    /* Every bit of the result depends on every bit of the state */
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,173 @@
+/***************************************************************************************************
+ * @file  PlyFile.hpp
+ * @brief Declaration of the PlyFile class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "StridedView.hpp"
+#include "ThreadPool.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @class PlyFile
+ * @brief A binary PLY file mapped in memory. Only its header is parsed when it is opened: the
+ * positions and triangles are then read in place from the mapping. When they are stored as
+ * little-endian floats and triangles of 32-bit indices, which is what most exporters write, they
+ * are exposed as views of the mapping and copied straight into meshes. Any other layout, including
+ * big-endian files, is converted by loops specialised on the type of each property.
+ */
+class PlyFile {
+public:
+    /**
+     * @enum Type
+     * @brief The scalar types of the properties.
+     */
+    enum class Type : std::uint8_t {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Float32,
+        Float64
+    };
+
+    /**
+     * @brief Maps a binary PLY file and parses its header. The file must have a vertex element with
+     * x, y and z properties and a face element with a vertex_indices or vertex_index list.
+     * @param path The path of the file.
+     */
+    explicit PlyFile(const std::string& path);
+
+    /**
+     * @brief Gives the number of vertices of the file.
+     * @return The number of vertices.
+     */
+    std::size_t get_vertex_count() const;
+
+    /**
+     * @brief Gives the number of triangles the faces of the file are split into.
+     * @return The number of triangles.
+     */
+    std::size_t get_triangle_count() const;
+
+    /**
+     * @brief Gives the positions of the vertices in place, without copying them.
+     * @return The view of the positions, empty unless x, y and z are consecutive little-endian floats.
+     */
+    StridedView<std::array<float, 3>> get_positions() const;
+
+    /**
+     * @brief Gives the triangles in place, without copying them.
+     * @return The view of the indices of the triangles, empty unless every face is a triangle of
+     * 32-bit little-endian indices and the index list is the only property of the faces.
+     */
+    StridedView<std::array<std::uint32_t, 3>> get_triangles() const;
+
+    /**
+     * @brief Creates a mesh of the triangles of the file. The faces are split into fans of triangles.
+     * @return The mesh.
+     */
+    TriangleMesh create_mesh() const;
+
+    /**
+     * @brief Creates a mesh of the triangles of the file, copying or converting the positions and
+     * triangles in parallel.
+     * @param pool The pool reading the file and building the BVH of the mesh.
+     * @return The mesh.
+     */
+    TriangleMesh create_mesh(ThreadPool& pool) const;
+
+private:
+    /**
+     * @struct Property
+     * @brief A property of an element, either a scalar or a list of scalars preceded by their count.
+     */
+    struct Property {
+        std::string name;   ///< The name of the property.
+        Type type;          ///< The type of the scalar, or of the items of the list.
+        Type count_type;    ///< The type of the count of the list.
+        bool is_list;       ///< Whether the property is a list.
+        std::size_t offset; ///< The offset of the property in the records, if they have a fixed size.
+    };
+
+    /**
+     * @struct Element
+     * @brief An element of the file, which is an array of records of the same properties.
+     */
+    struct Element {
+        std::string name;                 ///< The name of the element.
+        std::size_t count;                ///< The number of records.
+        std::vector<Property> properties; ///< The properties of the records.
+        std::size_t stride;               ///< The size of the records, 0 if they have lists.
+        const std::byte* data;            ///< The first record.
+    };
+
+    /**
+     * @brief Gives the size of a scalar type.
+     * @param type The type.
+     * @return The size in bytes.
+     */
+    static std::size_t get_size(Type type);
+
+    /**
+     * @brief Parses the header and finds where the data of every element starts.
+     */
+    void parse_header();
+
+    /**
+     * @brief Walks the records of an element whose size varies, checking that they stay in the
+     * file. The faces are also counted and checked for only being triangles.
+     * @param element The element.
+     * @return The byte following the last record.
+     */
+    const std::byte* scan_records(const Element& element);
+
+    /**
+     * @brief Finds the property of an element.
+     * @param element The element.
+     * @param name The name of the property.
+     * @return The property, nullptr if there is none.
+     */
+    static const Property* find_property(const Element& element, const std::string& name);
+
+    /**
+     * @brief Creates a mesh of the triangles of the file.
+     * @param pool The pool, nullptr to read the file from this thread.
+     * @return The mesh.
+     */
+    TriangleMesh create_mesh(ThreadPool* pool) const;
+
+    /**
+     * @brief Reads the positions of the vertices.
+     * @param pool The pool, nullptr to read them from this thread.
+     * @return The positions.
+     */
+    std::vector<vec3> read_positions(ThreadPool* pool) const;
+
+    /**
+     * @brief Reads the triangles of the faces.
+     * @param pool The pool, nullptr to read them from this thread.
+     * @return The indices of the triangles.
+     */
+    std::vector<std::uint32_t> read_indices(ThreadPool* pool) const;
+
+    std::string path;
+    MappedFile file;
+    bool is_big_endian;
+    std::vector<Element> elements;
+    const Element* vertices;
+    const Element* faces;
+    const Property* index_list;
+    std::size_t triangle_count;
+    bool has_direct_triangles;
+};
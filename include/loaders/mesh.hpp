@@ -0,0 +1,28 @@
+/***************************************************************************************************
+ * @file  mesh.hpp
+ * @brief Declaration of the loader of mesh files of any supported format
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+
+#include "ThreadPool.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @brief Loads the triangles of a mesh file with the loader of its format, given by its extension:
+ * .obj for Wavefront OBJ files and .ply for binary PLY files.
+ * @param path The path of the file.
+ * @return The mesh.
+ */
+TriangleMesh load_mesh(const std::string& path);
+
+/**
+ * @brief Loads the triangles of a mesh file in parallel with the loader of its format, given by its
+ * extension: .obj for Wavefront OBJ files and .ply for binary PLY files.
+ * @param path The path of the file.
+ * @param pool The pool running the loader.
+ * @return The mesh.
+ */
+TriangleMesh load_mesh(const std::string& path, ThreadPool& pool);
@@ -0,0 +1,31 @@
+/***************************************************************************************************
+ * @file  obj.hpp
+ * @brief Declaration of the Wavefront OBJ loader
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+
+#include "ThreadPool.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @brief Loads the triangles of a Wavefront OBJ file. Only the positions of the vertices and the
+ * faces are read, the faces being split into fans of triangles; negative indices count back from
+ * the last vertex defined before the face.
+ * @param path The path of the file.
+ * @return The mesh.
+ */
+TriangleMesh load_obj(const std::string& path);
+
+/**
+ * @brief Loads the triangles of a Wavefront OBJ file in parallel. The file is mapped in memory and
+ * split into chunks at line boundaries. A first pass over every chunk counts its vertices and
+ * triangles, which gives where each chunk writes in the arrays of the mesh, then a second pass
+ * parses the chunks straight into them.
+ * @param path The path of the file.
+ * @param pool The pool parsing the chunks.
+ * @return The mesh.
+ */
+TriangleMesh load_obj(const std::string& path, ThreadPool& pool);
@@ -0,0 +1,162 @@
+/***************************************************************************************************
+ * @file  parsing.hpp
+ * @brief Definition of the functions parsing numbers from text in place
+ **************************************************************************************************/
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+
+/**
+ * @brief Tests if a character separates the tokens of a line.
+ * @param character The character.
+ * @return Whether it is a space, a tab or a carriage return.
+ */
+constexpr bool is_blank(char character);
+
+/**
+ * @brief Tests if a character is a decimal digit.
+ * @param character The character.
+ * @return Whether it is between '0' and '9'.
+ */
+constexpr bool is_digit(char character);
+
+/**
+ * @brief Skips the blanks in front of a cursor.
+ * @param cursor The cursor.
+ * @param end The end of the text.
+ * @return The first character that is not a blank, or end.
+ */
+constexpr const char* skip_blanks(const char* cursor, const char* end);
+
+/**
+ * @brief Parses a decimal integer, with an optional sign.
+ * @param cursor The cursor, moved past the integer if there is one.
+ * @param end The end of the text.
+ * @param value Where the integer is written.
+ * @return Whether there was an integer.
+ */
+constexpr bool parse_integer(const char*& cursor, const char* end, std::int64_t& value);
+
+/**
+ * @brief Parses a decimal float, with an optional sign, fraction and exponent. Unlike the streams
+ * it ignores the locale. Up to 2^53 for the digits and 10^22 for the exponent, which covers the
+ * numbers written by exporters, the digits and the power of ten are exact doubles, so a single
+ * division or multiplication rounds them to the nearest double. Rounding that double to a float
+ * gives the nearest float too, unless it lies exactly halfway between two floats, in which case,
+ * like for anything else, the text is left to std::from_chars.
+ * @param cursor The cursor, moved past the float if there is one.
+ * @param end The end of the text.
+ * @param value Where the float is written.
+ * @return Whether there was a float.
+ */
+inline bool parse_float(const char*& cursor, const char* end, float& value);
+
+/* ---- Implementation ---- */
+
+constexpr bool is_blank(char character) {
+    return character == ' ' || character == '\t' || character == '\r';
+}
+
+constexpr bool is_digit(char character) {
+    return character >= '0' && character <= '9';
+}
+
+constexpr const char* skip_blanks(const char* cursor, const char* end) {
+    while(cursor != end && is_blank(*cursor)) { ++cursor; }
+    return cursor;
+}
+
+constexpr bool parse_integer(const char*& cursor, const char* end, std::int64_t& value) {
+    const char* digits = cursor != end && (*cursor == '-' || *cursor == '+') ? cursor + 1 : cursor;
+    if(digits == end || !is_digit(*digits)) { return false; }
+
+    std::uint64_t magnitude = 0;
+    for( ; digits != end && is_digit(*digits) ; ++digits) { magnitude = 10 * magnitude + (*digits - '0'); }
+
+    value = static_cast<std::int64_t>(*cursor == '-' ? -magnitude : magnitude);
+    cursor = digits;
+    return true;
+}
+
+inline bool parse_float(const char*& cursor, const char* end, float& value) {
+    static constexpr double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    /* The most digits an std::uint64_t holds whatever they are */
+    constexpr int max_digit_count = 19;
+
+    /* std::from_chars does not accept a plus sign */
+    const char* start = cursor != end && *cursor == '+' ? cursor + 1 : cursor;
+    const bool negative = start != end && *start == '-';
+    const char* current = negative ? start + 1 : start;
+
+    std::uint64_t mantissa = 0;
+    int digit_count = 0;
+    int exponent = 0;
+    bool has_digits = false;
+
+    /* Digits past the capacity of the mantissa only count in the integer part */
+    for( ; current != end && is_digit(*current) ; ++current) {
+        has_digits = true;
+        if(digit_count < max_digit_count) {
+            mantissa = 10 * mantissa + (*current - '0');
+            digit_count += mantissa != 0;
+        } else {
+            ++exponent;
+        }
+    }
+
+    if(current != end && *current == '.') {
+        for(++current ; current != end && is_digit(*current) ; ++current) {
+            has_digits = true;
+            if(digit_count < max_digit_count) {
+                mantissa = 10 * mantissa + (*current - '0');
+                digit_count += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+
+    /* An exponent marker without digits is not part of the float */
+    if(has_digits && current != end && (*current == 'e' || *current == 'E')) {
+        const char* exponent_digits = current + 1;
+        std::int64_t exponent_value;
+        if(parse_integer(exponent_digits, end, exponent_value)) {
+            exponent += static_cast<int>(exponent_value < -1000 ? -1000 : exponent_value > 1000 ? 1000 : exponent_value);
+            current = exponent_digits;
+        }
+    }
+
+    if(has_digits && mantissa <= std::uint64_t(1) << 53 && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+
+        /* A double halfway between two floats may have been rounded there from either side */
+        const float rounded = static_cast<float>(result);
+        const float neighbour = std::nextafter(rounded, result < rounded ? 0.0f : std::numeric_limits<float>::infinity());
+        if(static_cast<double>(rounded) + static_cast<double>(neighbour) != 2.0 * result) {
+            value = negative ? -rounded : rounded;
+            cursor = current;
+            return true;
+        }
+    }
+
+    /* Like strtof, values too small or too big for a float give zero or infinity */
+    std::from_chars_result result = std::from_chars(start, end, value);
+    if(result.ec == std::errc::result_out_of_range) {
+        value = exponent < 0 ? 0.0f : std::numeric_limits<float>::infinity();
+        value = negative ? -value : value;
+    } else if(result.ec != std::errc()) {
+        return false;
+    }
+
+    cursor = result.ptr;
+    return true;
+}
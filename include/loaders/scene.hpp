@@ -0,0 +1,39 @@
+/***************************************************************************************************
+ * @file  scene.hpp
+ * @brief Declaration of the scene description loader
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Loads a scene description file. Every line holds a directive followed by its arguments,
+ * separated by blanks, and '#' starts a comment running to the end of the line:
+ *  - resolution <width> <height>, required
+ *  - camera <position x y z> <look at x y z> <up x y z> <vertical fov in degrees>, required
+ *  - samples <count>, 1 by default
+ *  - output <path>, a .png, .pfm or .hdr file, data/img.png by default
+ *  - sky <color looking down r g b> <color looking up r g b>
+ *  - builder <sah|morton>, the algorithm building the BVHs, sah by default
+ *  - cache <directory>, a mesh cache the meshes are loaded through
+ *  - material <name> <albedo r g b>
+ *  - sphere <center x y z> <radius> [material]
+ *  - mesh <path> [material]
+ *  - instance <path> <translation x y z> <rotation angle in degrees> <rotation axis x y z>
+ *    <scale x y z> [material], the meshes instanced several times being loaded once.
+ *
+ * The file is mapped in memory and parsed in a single pass, the words and numbers being read in
+ * place. Materials must be defined once, before being used. Degenerate values are rejected: a
+ * radius that is not positive, a fov outside (0, 180), a camera looking along its up vector, a zero
+ * rotation axis or a zero scale. The paths of the meshes are relative to the scene file, the output
+ * and cache ones to the working directory. The meshes are loaded and the BVHs built once the whole
+ * file is parsed.
+ * @param path The path of the file.
+ * @param pool The pool loading the meshes and building the BVHs.
+ * @return The scene.
+ */
+Scene load_scene(const std::string& path, ThreadPool& pool);
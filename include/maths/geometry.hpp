@@ -1,10 +1,12 @@
 /***************************************************************************************************
  * @file  geometry.hpp
- * @brief Declaration of some functions regarding vector maths
+ * @brief Definition of some functions regarding vector maths
  **************************************************************************************************/
 
 #pragma once
 
+#include <cmath>
+
 #include "vec2.hpp"
 #include "vec3.hpp"
 #include "vec4.hpp"
@@ -14,21 +16,21 @@
  * @param vec The vec2.
  * @return The length.
  */
-float length(const vec2& vec);
+inline float length(const vec2& vec);
 
 /**
  * @brief Calculates the length of a vec3.
  * @param vec The vec3.
  * @return The length.
  */
-float length(const vec3& vec);
+inline float length(const vec3& vec);
 
 /**
  * @brief Calculates the length of a vec4.
  * @param vec The vec4.
  * @return The length.
  */
-float length(const vec4& vec);
+inline float length(const vec4& vec);
 
 /**
  * @brief Calculates the dot product of two vec2.
@@ -36,7 +38,7 @@ float length(const vec4& vec);
  * @param right The right operand.
  * @return The dot product of the two vec2.
  */
-float dot(const vec2& left, const vec2& right);
+constexpr float dot(const vec2& left, const vec2& right);
 
 /**
  * @brief Calculates the dot product of two vec3.
@@ -44,7 +46,7 @@ float dot(const vec2& left, const vec2& right);
  * @param right The right operand.
  * @return The dot product of the two vec3.
  */
-float dot(const vec3& left, const vec3& right);
+constexpr float dot(const vec3& left, const vec3& right);
 
 /**
  * @brief Calculates the dot product of two vec4.
@@ -52,28 +54,28 @@ float dot(const vec3& left, const vec3& right);
  * @param right The right operand.
  * @return The dot product of the two vec4.
  */
-float dot(const vec4& left, const vec4& right);
+constexpr float dot(const vec4& left, const vec4& right);
 
 /**
  * @brief Calculates the normalized vector of a vec2.
  * @param vec The vec2.
  * @return The normalized vec2.
  */
-vec2 normalize(const vec2& vec);
+inline vec2 normalize(const vec2& vec);
 
 /**
  * @brief Calculates the normalized vector of a vec3.
  * @param vec The vec3.
  * @return The normalized vec3.
  */
-vec3 normalize(const vec3& vec);
+inline vec3 normalize(const vec3& vec);
 
 /**
  * @brief Calculates the normalized vector of a vec4.
  * @param vec The vec4.
  * @return The normalized vec4.
  */
-vec4 normalize(const vec4& vec);
+inline vec4 normalize(const vec4& vec);
 
 /**
  * @brief Calculates the cross product of two vec3.
@@ -81,4 +83,127 @@ vec4 normalize(const vec4& vec);
  * @param right The right operand.
  * @return The cross product of the two vec3.
  */
-vec3 cross(const vec3& left, const vec3& right);
\ No newline at end of file
+constexpr vec3 cross(const vec3& left, const vec3& right);
+
+/**
+ * @brief Calculates the component-wise minimum of two vec3.
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The smallest of each component.
+ */
+constexpr vec3 min(const vec3& left, const vec3& right);
+
+/**
+ * @brief Calculates the component-wise maximum of two vec3.
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The largest of each component.
+ */
+constexpr vec3 max(const vec3& left, const vec3& right);
+
+/* ---- Implementation ---- */
+
+inline float length(const vec2& vec) {
+    return std::sqrt(vec.x * vec.x + vec.y * vec.y);
+}
+
+inline float length(const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    return _mm_cvtss_f32(_mm_sqrt_ss(simd_sum(_mm_mul_ps(vec.simd, vec.simd))));
+#else
+    return std::sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z);
+#endif
+}
+
+inline float length(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    return _mm_cvtss_f32(_mm_sqrt_ss(simd_sum(_mm_mul_ps(vec.simd, vec.simd))));
+#else
+    return std::sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z + vec.w * vec.w);
+#endif
+}
+
+constexpr float dot(const vec2& left, const vec2& right) {
+    return left.x * right.x + left.y * right.y;
+}
+
+constexpr float dot(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return _mm_cvtss_f32(simd_sum(_mm_mul_ps(left.simd, right.simd))); }
+#endif
+
+    return left.x * right.x + left.y * right.y + left.z * right.z;
+}
+
+constexpr float dot(const vec4& left, const vec4& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return _mm_cvtss_f32(simd_sum(_mm_mul_ps(left.simd, right.simd))); }
+#endif
+
+    return left.x * right.x + left.y * right.y + left.z * right.z + left.w * right.w;
+}
+
+inline vec2 normalize(const vec2& vec) {
+    return vec / length(vec);
+}
+
+inline vec3 normalize(const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    /* The padding is divided by 1 rather than by the length, which may be 0 */
+    __m128 length = _mm_blend_ps(_mm_sqrt_ps(simd_sum(_mm_mul_ps(vec.simd, vec.simd))), _mm_set1_ps(1.0f), 0x8);
+    return vec3(_mm_div_ps(vec.simd, length));
+#else
+    return vec / length(vec);
+#endif
+}
+
+inline vec4 normalize(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    return vec4(_mm_div_ps(vec.simd, _mm_sqrt_ps(simd_sum(_mm_mul_ps(vec.simd, vec.simd)))));
+#else
+    return vec / length(vec);
+#endif
+}
+
+constexpr vec3 cross(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        __m128 left_yzx = _mm_shuffle_ps(left.simd, left.simd, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 left_zxy = _mm_shuffle_ps(left.simd, left.simd, _MM_SHUFFLE(3, 1, 0, 2));
+        __m128 right_yzx = _mm_shuffle_ps(right.simd, right.simd, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 right_zxy = _mm_shuffle_ps(right.simd, right.simd, _MM_SHUFFLE(3, 1, 0, 2));
+
+        return vec3(_mm_sub_ps(_mm_mul_ps(left_yzx, right_zxy), _mm_mul_ps(left_zxy, right_yzx)));
+    }
+#endif
+
+    return vec3(
+        left.y * right.z - left.z * right.y,
+        left.z * right.x - left.x * right.z,
+        left.x * right.y - left.y * right.x
+    );
+}
+
+constexpr vec3 min(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_min_ps(left.simd, right.simd)); }
+#endif
+
+    return vec3(
+        left.x < right.x ? left.x : right.x,
+        left.y < right.y ? left.y : right.y,
+        left.z < right.z ? left.z : right.z
+    );
+}
+
+constexpr vec3 max(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_max_ps(left.simd, right.simd)); }
+#endif
+
+    return vec3(
+        left.x > right.x ? left.x : right.x,
+        left.y > right.y ? left.y : right.y,
+        left.z > right.z ? left.z : right.z
+    );
+}
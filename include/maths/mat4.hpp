@@ -0,0 +1,246 @@
+/***************************************************************************************************
+ * @file  mat4.hpp
+ * @brief Definition of the mat4 struct and of the affine transforms
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cmath>
+
+#include "geometry.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+
+/**
+ * @struct mat4
+ * @brief A 4x4 matrix of floats stored as 4 columns, so that multiplying it by a vec4 is a sum of
+ * its columns scaled by the components of the vec4.
+ */
+struct mat4 {
+    /**
+     * @brief Constructs the identity matrix.
+     */
+    constexpr mat4();
+
+    /**
+     * @brief Constructs a matrix from its columns.
+     * @param column0 The first column.
+     * @param column1 The second column.
+     * @param column2 The third column.
+     * @param column3 The fourth column.
+     */
+    constexpr mat4(const vec4& column0, const vec4& column1, const vec4& column2, const vec4& column3);
+
+    /**
+     * @brief Gives a column of the matrix.
+     * @param column The index of the column, between 0 and 3.
+     * @return A reference to the column.
+     */
+    constexpr vec4& operator [](unsigned int column);
+
+    /**
+     * @brief Gives a column of the matrix.
+     * @param column The index of the column, between 0 and 3.
+     * @return A const reference to the column.
+     */
+    constexpr const vec4& operator [](unsigned int column) const;
+
+    vec4 columns[4]; ///< The columns of the matrix.
+};
+
+/**
+ * @brief Multiplies two mat4.
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The matrix applying right then left.
+ */
+constexpr mat4 operator *(const mat4& left, const mat4& right);
+
+/**
+ * @brief Multiplies a mat4 by a vec4.
+ * @param mat The mat4.
+ * @param vec The vec4.
+ * @return The transformed vec4.
+ */
+constexpr vec4 operator *(const mat4& mat, const vec4& vec);
+
+/**
+ * @brief Calculates the transpose of a mat4.
+ * @param mat The mat4.
+ * @return The transpose.
+ */
+constexpr mat4 transpose(const mat4& mat);
+
+/**
+ * @brief Calculates the inverse of a mat4 from its cofactors.
+ * @param mat The mat4, which must be invertible.
+ * @return The inverse.
+ */
+constexpr mat4 inverse(const mat4& mat);
+
+/**
+ * @brief Transforms a point, which is affected by the translation of the matrix.
+ * @param mat The affine transform.
+ * @param point The point.
+ * @return The transformed point.
+ */
+constexpr vec3 transform_point(const mat4& mat, const vec3& point);
+
+/**
+ * @brief Transforms a vector, which is not affected by the translation of the matrix.
+ * @param mat The affine transform.
+ * @param vector The vector.
+ * @return The transformed vector.
+ */
+constexpr vec3 transform_vector(const mat4& mat, const vec3& vector);
+
+/**
+ * @brief Calculates the matrix of a translation.
+ * @param offset The translation.
+ * @return The matrix.
+ */
+constexpr mat4 translate(const vec3& offset);
+
+/**
+ * @brief Calculates the matrix of a scale.
+ * @param factors The scale factor along each axis.
+ * @return The matrix.
+ */
+constexpr mat4 scale(const vec3& factors);
+
+/**
+ * @brief Calculates the matrix of a rotation.
+ * @param angle The counterclockwise angle of the rotation in radians.
+ * @param axis The axis of the rotation.
+ * @return The matrix.
+ */
+inline mat4 rotate(float angle, const vec3& axis);
+
+/* ---- Implementation ---- */
+
+constexpr mat4::mat4()
+    : columns{ vec4(1.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 1.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 1.0f, 0.0f),
+               vec4(0.0f, 0.0f, 0.0f, 1.0f) } { }
+
+constexpr mat4::mat4(const vec4& column0, const vec4& column1, const vec4& column2, const vec4& column3)
+    : columns{ column0, column1, column2, column3 } { }
+
+constexpr vec4& mat4::operator[](unsigned int column) {
+    return columns[column];
+}
+
+constexpr const vec4& mat4::operator[](unsigned int column) const {
+    return columns[column];
+}
+
+constexpr mat4 operator*(const mat4& left, const mat4& right) {
+    return mat4(left * right[0], left * right[1], left * right[2], left * right[3]);
+}
+
+constexpr vec4 operator*(const mat4& mat, const vec4& vec) {
+    return mat[0] * vec.x + mat[1] * vec.y + mat[2] * vec.z + mat[3] * vec.w;
+}
+
+constexpr mat4 transpose(const mat4& mat) {
+    return mat4(
+        vec4(mat[0].x, mat[1].x, mat[2].x, mat[3].x),
+        vec4(mat[0].y, mat[1].y, mat[2].y, mat[3].y),
+        vec4(mat[0].z, mat[1].z, mat[2].z, mat[3].z),
+        vec4(mat[0].w, mat[1].w, mat[2].w, mat[3].w)
+    );
+}
+
+constexpr mat4 inverse(const mat4& mat) {
+    /* The 2x2 determinants of the two upper and two lower rows, shared by the cofactors */
+    float upper01 = mat[0].x * mat[1].y - mat[1].x * mat[0].y;
+    float upper02 = mat[0].x * mat[2].y - mat[2].x * mat[0].y;
+    float upper03 = mat[0].x * mat[3].y - mat[3].x * mat[0].y;
+    float upper12 = mat[1].x * mat[2].y - mat[2].x * mat[1].y;
+    float upper13 = mat[1].x * mat[3].y - mat[3].x * mat[1].y;
+    float upper23 = mat[2].x * mat[3].y - mat[3].x * mat[2].y;
+
+    float lower01 = mat[0].z * mat[1].w - mat[1].z * mat[0].w;
+    float lower02 = mat[0].z * mat[2].w - mat[2].z * mat[0].w;
+    float lower03 = mat[0].z * mat[3].w - mat[3].z * mat[0].w;
+    float lower12 = mat[1].z * mat[2].w - mat[2].z * mat[1].w;
+    float lower13 = mat[1].z * mat[3].w - mat[3].z * mat[1].w;
+    float lower23 = mat[2].z * mat[3].w - mat[3].z * mat[2].w;
+
+    float determinant = upper01 * lower23 - upper02 * lower13 + upper03 * lower12
+                        + upper12 * lower03 - upper13 * lower02 + upper23 * lower01;
+    float inverse_determinant = 1.0f / determinant;
+
+    return mat4(
+        inverse_determinant * vec4(
+            mat[1].y * lower23 - mat[2].y * lower13 + mat[3].y * lower12,
+            -mat[0].y * lower23 + mat[2].y * lower03 - mat[3].y * lower02,
+            mat[0].y * lower13 - mat[1].y * lower03 + mat[3].y * lower01,
+            -mat[0].y * lower12 + mat[1].y * lower02 - mat[2].y * lower01
+        ),
+        inverse_determinant * vec4(
+            -mat[1].x * lower23 + mat[2].x * lower13 - mat[3].x * lower12,
+            mat[0].x * lower23 - mat[2].x * lower03 + mat[3].x * lower02,
+            -mat[0].x * lower13 + mat[1].x * lower03 - mat[3].x * lower01,
+            mat[0].x * lower12 - mat[1].x * lower02 + mat[2].x * lower01
+        ),
+        inverse_determinant * vec4(
+            mat[1].w * upper23 - mat[2].w * upper13 + mat[3].w * upper12,
+            -mat[0].w * upper23 + mat[2].w * upper03 - mat[3].w * upper02,
+            mat[0].w * upper13 - mat[1].w * upper03 + mat[3].w * upper01,
+            -mat[0].w * upper12 + mat[1].w * upper02 - mat[2].w * upper01
+        ),
+        inverse_determinant * vec4(
+            -mat[1].z * upper23 + mat[2].z * upper13 - mat[3].z * upper12,
+            mat[0].z * upper23 - mat[2].z * upper03 + mat[3].z * upper02,
+            -mat[0].z * upper13 + mat[1].z * upper03 - mat[3].z * upper01,
+            mat[0].z * upper12 - mat[1].z * upper02 + mat[2].z * upper01
+        )
+    );
+}
+
+constexpr vec3 transform_point(const mat4& mat, const vec3& point) {
+    vec4 transformed = mat * vec4(point.x, point.y, point.z, 1.0f);
+    return vec3(transformed.x, transformed.y, transformed.z);
+}
+
+constexpr vec3 transform_vector(const mat4& mat, const vec3& vector) {
+    vec4 transformed = mat * vec4(vector.x, vector.y, vector.z, 0.0f);
+    return vec3(transformed.x, transformed.y, transformed.z);
+}
+
+constexpr mat4 translate(const vec3& offset) {
+    mat4 mat;
+    mat[3] = vec4(offset.x, offset.y, offset.z, 1.0f);
+
+    return mat;
+}
+
+constexpr mat4 scale(const vec3& factors) {
+    mat4 mat;
+    mat[0].x = factors.x;
+    mat[1].y = factors.y;
+    mat[2].z = factors.z;
+
+    return mat;
+}
+
+inline mat4 rotate(float angle, const vec3& axis) {
+    const vec3 unit = normalize(axis);
+    const float cos = std::cos(angle);
+    const float sin = std::sin(angle);
+    const float one_minus_cos = 1.0f - cos;
+
+    /* Rodrigues' rotation formula */
+    return mat4(
+        vec4(cos + unit.x * unit.x * one_minus_cos,
+             unit.y * unit.x * one_minus_cos + unit.z * sin,
+             unit.z * unit.x * one_minus_cos - unit.y * sin, 0.0f),
+        vec4(unit.x * unit.y * one_minus_cos - unit.z * sin,
+             cos + unit.y * unit.y * one_minus_cos,
+             unit.z * unit.y * one_minus_cos + unit.x * sin, 0.0f),
+        vec4(unit.x * unit.z * one_minus_cos + unit.y * sin,
+             unit.y * unit.z * one_minus_cos - unit.x * sin,
+             cos + unit.z * unit.z * one_minus_cos, 0.0f),
+        vec4(0.0f, 0.0f, 0.0f, 1.0f)
+    );
+}
@@ -0,0 +1,32 @@
+/***************************************************************************************************
+ * @file  simd.hpp
+ * @brief Selection of the SIMD backend of the maths module
+ **************************************************************************************************/
+
+#pragma once
+
+/**
+ * The backend is chosen at build time with the MATHS_SIMD CMake option:
+ * - NONE : Scalar code only, vec3 holds 3 floats.
+ * - SSE4 : vec4 is stored in an __m128 and vec3 in an __m128 whose 4th lane is a padding kept at 0.
+ * - AVX2 : Same as SSE4 and enables the 8-wide kernels.
+ */
+
+#if defined(MATHS_SIMD_AVX2) && !defined(MATHS_SIMD_SSE4)
+#define MATHS_SIMD_SSE4
+#endif
+
+#ifdef MATHS_SIMD_SSE4
+#include <immintrin.h>
+
+/**
+ * @brief Sums the 4 lanes of a SIMD register. Two shuffles and two additions are faster than a
+ * single dpps on most CPUs.
+ * @param value The register.
+ * @return A register whose 4 lanes hold the sum.
+ */
+inline __m128 simd_sum(__m128 value) {
+    __m128 sum = _mm_add_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+#endif
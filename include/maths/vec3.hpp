@@ -1,21 +1,24 @@
 /***************************************************************************************************
  * @file  vec3.hpp
- * @brief Declaration of the vec3 struct
+ * @brief Definition of the vec3 struct
  **************************************************************************************************/
 
 #pragma once
 
 #include <iostream>
 
+#include "simd.hpp"
+
 /**
  * @class vec3
- * @brief Holds 3 float values.
+ * @brief Holds 3 float values. With a SIMD backend, a 4th padding lane is added so that the vec3
+ * fits in an aligned __m128.
  */
 struct vec3 {
     /**
      * @brief Constructs a vec3 with all components set to 0.
      */
-    vec3();
+    constexpr vec3();
 
     /**
      * @brief Constructs a vec3 with a specific value for each component.
@@ -23,89 +26,100 @@ struct vec3 {
      * @param y The value of the y component.
      * @param z The value of the z component.
      */
-    vec3(float x, float y, float z);
+    constexpr vec3(float x, float y, float z);
 
     /**
      * @brief Constructs a vec3 with the same value for each component.
      * @param value The value of each component.
      */
-    explicit vec3(float value);
+    explicit constexpr vec3(float value);
+
+#ifdef MATHS_SIMD_SSE4
+    /**
+     * @brief Constructs a vec3 from a SIMD register.
+     * @param simd The register holding the x, y and z components, its 4th lane must be 0.
+     */
+    explicit vec3(__m128 simd);
+#endif
 
     /**
      * @brief Adds another vec3's components to the current instance's components.
      * @param vec The vec3 to add.
      * @return A reference to this instance.
      */
-    vec3& operator +=(const vec3& vec);
+    constexpr vec3& operator +=(const vec3& vec);
 
     /**
      * @brief Subtracts the current instance's components by another vec3's components.
      * @param vec The vec3 to subtract by.
      * @return A reference to this instance.
      */
-    vec3& operator -=(const vec3& vec);
+    constexpr vec3& operator -=(const vec3& vec);
 
     /**
      * @brief Multiplies the current instance's components by another vec3's components.
      * @param vec The vec3 to multiply by.
      * @return A reference to this instance.
      */
-    vec3& operator *=(const vec3& vec);
+    constexpr vec3& operator *=(const vec3& vec);
 
     /**
      * @brief Divides the current instance's components by another vec3's components.
      * @param vec The vec3 to divide by.
      * @return A reference to this instance.
      */
-    vec3& operator /=(const vec3& vec);
+    constexpr vec3& operator /=(const vec3& vec);
 
     /**
      * @brief Adds a value to all of the current instance's components.
      * @param value The value to add.
      * @return A reference to this instance.
      */
-    vec3& operator +=(float value);
+    constexpr vec3& operator +=(float value);
 
     /**
      * @brief Subtracts all of the current instance's components by a value.
      * @param value The value to subtract by.
      * @return A reference to this instance.
      */
-    vec3& operator -=(float value);
+    constexpr vec3& operator -=(float value);
 
     /**
      * @brief Multiplies all of the current instance's components by a value.
      * @param value The value to multiply by.
      * @return A reference to this instance.
      */
-    vec3& operator *=(float value);
+    constexpr vec3& operator *=(float value);
 
     /**
      * @brief Divides all of the current instance's components by a value.
      * @param value The value to divide by.
      * @return A reference to this instance.
      */
-    vec3& operator /=(float value);
+    constexpr vec3& operator /=(float value);
 
     /**
      * @brief Tests if this vec3 is equal to an other one.
      * @param other The vec3 to compare with.
      * @return Whether the two vec3 are equal.
      */
-    bool operator ==(const vec3& other) const;
+    constexpr bool operator ==(const vec3& other) const;
 
     /**
      * @brief Tests if this vec3 is different than an other one.
      * @param other The vec3 to compare with.
      * @return Whether the two vec3 are different.
      */
-    bool operator !=(const vec3& other) const;
+    constexpr bool operator !=(const vec3& other) const;
 
     union {
         struct {
             float x; ///< The x component of the vec3.
             float y; ///< The y component of the vec3.
             float z; ///< The z component of the vec3.
+#ifdef MATHS_SIMD_SSE4
+            float padding; ///< The 4th lane of the SIMD register, kept at 0 by every operation.
+#endif
         };
 
         struct {
@@ -113,6 +127,10 @@ struct vec3 {
             float g; ///< The g component of the color.
             float b; ///< The b component of the color.
         };
+
+#ifdef MATHS_SIMD_SSE4
+        __m128 simd; ///< The 3 components and the padding as a SIMD register.
+#endif
     };
 };
 
@@ -123,7 +141,7 @@ struct vec3 {
  * @param vec The vec3 to write to the stream.
  * @return A reference to the output stream after writing the vec3.
  */
-std::ostream& operator <<(std::ostream& stream, const vec3& vec);
+inline std::ostream& operator <<(std::ostream& stream, const vec3& vec);
 
 /**
  * @brief Reads four values from the input stream and assigns them to the x, y and z components of
@@ -132,74 +150,329 @@ std::ostream& operator <<(std::ostream& stream, const vec3& vec);
  * @param vec The vec3 to assign the read values to.
  * @return A reference to the input stream after reading the values and assigning them to vec3.
  */
-std::istream& operator >>(std::istream& stream, vec3& vec);
+inline std::istream& operator >>(std::istream& stream, vec3& vec);
 
 /** @brief Adds a vec3's components to another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise sum of the two vec3.
  */
-vec3 operator +(const vec3& left, const vec3& right);
+constexpr vec3 operator +(const vec3& left, const vec3& right);
 
 /** @brief Subtracts a vec3's components by another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise subtraction of the first vec3 by the second.
  */
-vec3 operator -(const vec3& left, const vec3& right);
+constexpr vec3 operator -(const vec3& left, const vec3& right);
 
 /** @brief Multiplies a vec3's components by another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise product of the two vec3.
  */
-vec3 operator *(const vec3& left, const vec3& right);
+constexpr vec3 operator *(const vec3& left, const vec3& right);
 
 /** @brief Divides a vec3's components by another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise division of the first vec3 by the second.
  */
-vec3 operator /(const vec3& left, const vec3& right);
+constexpr vec3 operator /(const vec3& left, const vec3& right);
 
 /** @brief Adds a value to each of a vec3's components.
  *  @param vec The vec3.
  *  @param value The value.
  *  @return The component-wise sum of a vec3 by a value.
  */
-vec3 operator +(const vec3& vec, float value);
+constexpr vec3 operator +(const vec3& vec, float value);
 
 /** @brief Subtracts each of a vec3's components by a value.
  *  @param vec The vec3.
  *  @param value The value.
  *  @return The component-wise subtraction of a vec3 by a value.
  */
-vec3 operator -(const vec3& vec, float value);
+constexpr vec3 operator -(const vec3& vec, float value);
 
 /** @brief Multiplies each of a vec3's components by a value.
  *  @param vec The vec3.
  *  @param value The value.
  *  @return The component-wise product of a vec3 by a value.
  */
-vec3 operator *(const vec3& vec, float value);
+constexpr vec3 operator *(const vec3& vec, float value);
 
 /** @brief Multiplies each of a vec3's components by a value.
  *  @param value The value.
  *  @param vec The vec3.
  *  @return The component-wise product of a vec3 by a value.
  */
-vec3 operator *(float value, const vec3& vec);
+constexpr vec3 operator *(float value, const vec3& vec);
 
 /** @brief Divides each of a vec3's components by a value.
  *  @param vec The vec3.
  *  @param value The value.
  *  @return The component-wise division of a vec3 by a value.
  */
-vec3 operator /(const vec3& vec, float value);
+constexpr vec3 operator /(const vec3& vec, float value);
 
 /**
  * @brief Multiplies all of a vec3's components by -1.
  *  @param vec The vec3.
  *  @return The component-wise product of a vec3 by -1.
  */
-vec3 operator -(const vec3& vec);
+constexpr vec3 operator -(const vec3& vec);
+
+/* ---- Implementation ---- */
+
+#ifdef MATHS_SIMD_SSE4
+constexpr vec3::vec3() : x(), y(), z(), padding() {
+    if !consteval { simd = _mm_setzero_ps(); }
+}
+
+/* At runtime the register is built directly, going through the scalar members would make the next
+ * packed load wait on 3 separate stores */
+constexpr vec3::vec3(float x, float y, float z) : x(x), y(y), z(z), padding() {
+    if !consteval { simd = _mm_setr_ps(x, y, z, 0.0f); }
+}
+
+constexpr vec3::vec3(float value) : x(value), y(value), z(value), padding() {
+    if !consteval { simd = _mm_setr_ps(value, value, value, 0.0f); }
+}
+
+inline vec3::vec3(__m128 simd) : simd(simd) { }
+#else
+constexpr vec3::vec3() : x(), y(), z() { }
+
+constexpr vec3::vec3(float x, float y, float z) : x(x), y(y), z(z) { }
+
+constexpr vec3::vec3(float value) : x(value), y(value), z(value) { }
+#endif
+
+constexpr vec3& vec3::operator+=(const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_add_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x += vec.x;
+    y += vec.y;
+    z += vec.z;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator-=(const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_sub_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x -= vec.x;
+    y -= vec.y;
+    z -= vec.z;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator*=(const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_mul_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x *= vec.x;
+    y *= vec.y;
+    z *= vec.z;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator/=(const vec3& vec) {
+    x /= vec.x;
+    y /= vec.y;
+    z /= vec.z;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator+=(float value) {
+    x += value;
+    y += value;
+    z += value;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator-=(float value) {
+    x -= value;
+    y -= value;
+    z -= value;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator*=(float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_mul_ps(simd, _mm_setr_ps(value, value, value, 0.0f));
+        return *this;
+    }
+#endif
+
+    x *= value;
+    y *= value;
+    z *= value;
+
+    return *this;
+}
+
+constexpr vec3& vec3::operator/=(float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_div_ps(simd, _mm_setr_ps(value, value, value, 1.0f));
+        return *this;
+    }
+#endif
+
+    x /= value;
+    y /= value;
+    z /= value;
+
+    return *this;
+}
+
+constexpr bool vec3::operator==(const vec3& other) const {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return (_mm_movemask_ps(_mm_cmpeq_ps(simd, other.simd)) & 0x7) == 0x7; }
+#endif
+
+    return x == other.x && y == other.y && z == other.z;
+}
+
+constexpr bool vec3::operator!=(const vec3& other) const {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return (_mm_movemask_ps(_mm_cmpneq_ps(simd, other.simd)) & 0x7) != 0; }
+#endif
+
+    return x != other.x || y != other.y || z != other.z;
+}
+
+inline std::ostream& operator<<(std::ostream& stream, const vec3& vec) {
+    stream << "( " << vec.x << " ; " << vec.y << " ; " << vec.z << " )";
+    return stream;
+}
+
+inline std::istream& operator>>(std::istream& stream, vec3& vec) {
+    stream >> vec.x >> vec.y >> vec.z;
+    return stream;
+}
+
+constexpr vec3 operator+(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_add_ps(left.simd, right.simd)); }
+#endif
+
+    return vec3(
+        left.x + right.x,
+        left.y + right.y,
+        left.z + right.z
+    );
+}
+
+constexpr vec3 operator-(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_sub_ps(left.simd, right.simd)); }
+#endif
+
+    return vec3(
+        left.x - right.x,
+        left.y - right.y,
+        left.z - right.z
+    );
+}
+
+constexpr vec3 operator*(const vec3& left, const vec3& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_mul_ps(left.simd, right.simd)); }
+#endif
+
+    return vec3(
+        left.x * right.x,
+        left.y * right.y,
+        left.z * right.z
+    );
+}
+
+constexpr vec3 operator/(const vec3& left, const vec3& right) {
+    return vec3(
+        left.x / right.x,
+        left.y / right.y,
+        left.z / right.z
+    );
+}
+
+constexpr vec3 operator+(const vec3& vec, float value) {
+    return vec3(
+        vec.x + value,
+        vec.y + value,
+        vec.z + value
+    );
+}
+
+constexpr vec3 operator-(const vec3& vec, float value) {
+    return vec3(
+        vec.x - value,
+        vec.y - value,
+        vec.z - value
+    );
+}
+
+constexpr vec3 operator*(const vec3& vec, float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_mul_ps(vec.simd, _mm_setr_ps(value, value, value, 0.0f))); }
+#endif
+
+    return vec3(
+        vec.x * value,
+        vec.y * value,
+        vec.z * value
+    );
+}
+
+constexpr vec3 operator*(float value, const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_mul_ps(_mm_setr_ps(value, value, value, 0.0f), vec.simd)); }
+#endif
+
+    return vec3(
+        value * vec.x,
+        value * vec.y,
+        value * vec.z
+    );
+}
+
+constexpr vec3 operator/(const vec3& vec, float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_div_ps(vec.simd, _mm_setr_ps(value, value, value, 1.0f))); }
+#endif
+
+    return vec3(
+        vec.x / value,
+        vec.y / value,
+        vec.z / value
+    );
+}
+
+constexpr vec3 operator-(const vec3& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec3(_mm_xor_ps(vec.simd, _mm_set1_ps(-0.0f))); }
+#endif
+
+    return vec3(-vec.x, -vec.y, -vec.z);
+}
@@ -1,12 +1,14 @@
 /***************************************************************************************************
  * @file  vec4.hpp
- * @brief Declaration of the vec4 class
+ * @brief Definition of the vec4 class
  **************************************************************************************************/
 
 #pragma once
 
 #include <iostream>
 
+#include "simd.hpp"
+
 /**
  * @class vec4
  * @brief Holds 4 float values.
@@ -15,7 +17,7 @@ struct vec4 {
     /**
      * @brief Constructs a vec4 with all components set to 0.
      */
-    vec4();
+    constexpr vec4();
 
     /**
      * @brief Constructs a vec4 with a specific value for each component.
@@ -24,83 +26,91 @@ struct vec4 {
      * @param z The value of the z component.
      * @param w The value of the w component.
      */
-    vec4(float x, float y, float z, float w);
+    constexpr vec4(float x, float y, float z, float w);
 
     /**
      * @brief Constructs a vec4 with the same value for each component.
      * @param value The value of each component.
      */
-    explicit vec4(float value);
+    explicit constexpr vec4(float value);
+
+#ifdef MATHS_SIMD_SSE4
+    /**
+     * @brief Constructs a vec4 from a SIMD register.
+     * @param simd The register holding the x, y, z and w components.
+     */
+    explicit vec4(__m128 simd);
+#endif
 
     /**
      * @brief Adds another vec4's components to the current instance's components.
      * @param vec The vec4 to add.
      * @return A reference to this instance.
      */
-    vec4& operator +=(const vec4& vec);
+    constexpr vec4& operator +=(const vec4& vec);
 
     /**
      * @brief Subtracts the current instance's components by another vec4's components.
      * @param vec The vec4 to subtract by.
      * @return A reference to this instance.
      */
-    vec4& operator -=(const vec4& vec);
+    constexpr vec4& operator -=(const vec4& vec);
 
     /**
      * @brief Multiplies the current instance's components by another vec4's components.
      * @param vec The vec4 to multiply by.
      * @return A reference to this instance.
      */
-    vec4& operator *=(const vec4& vec);
+    constexpr vec4& operator *=(const vec4& vec);
 
     /**
      * @brief Divides the current instance's components by another vec4's components.
      * @param vec The vec4 to divide by.
      * @return A reference to this instance.
      */
-    vec4& operator /=(const vec4& vec);
+    constexpr vec4& operator /=(const vec4& vec);
 
     /**
      * @brief Adds a value to all of the current instance's components.
      * @param value The value to add.
      * @return A reference to this instance.
      */
-    vec4& operator +=(float value);
+    constexpr vec4& operator +=(float value);
 
     /**
      * @brief Subtracts all of the current instance's components by a value.
      * @param value The value to subtract by.
      * @return A reference to this instance.
      */
-    vec4& operator -=(float value);
+    constexpr vec4& operator -=(float value);
 
     /**
      * @brief Multiplies all of the current instance's components by a value.
      * @param value The value to multiply by.
      * @return A reference to this instance.
      */
-    vec4& operator *=(float value);
+    constexpr vec4& operator *=(float value);
 
     /**
      * @brief Divides all of the current instance's components by a value.
      * @param value The value to divide by.
      * @return A reference to this instance.
      */
-    vec4& operator /=(float value);
+    constexpr vec4& operator /=(float value);
 
     /**
      * @brief Tests if this vec4 is equal to an other one.
      * @param other The vec4 to compare with.
      * @return Whether the two vec4 are equal.
      */
-    bool operator ==(const vec4& other) const;
+    constexpr bool operator ==(const vec4& other) const;
 
     /**
      * @brief Tests if this vec4 is different than an other one.
      * @param other The vec4 to compare with.
      * @return Whether the two vec4 are different.
      */
-    bool operator !=(const vec4& other) const;
+    constexpr bool operator !=(const vec4& other) const;
 
     union {
         struct {
@@ -116,6 +126,10 @@ struct vec4 {
             float b; ///< The b component of the color.
             float a; ///< The a component of the color.
         };
+
+#ifdef MATHS_SIMD_SSE4
+        __m128 simd; ///< The 4 components as a SIMD register.
+#endif
     };
 };
 
@@ -126,7 +140,7 @@ struct vec4 {
  * @param vec The vec4 to write to the stream.
  * @return A reference to the output stream after writing the vec4.
  */
-std::ostream& operator <<(std::ostream& stream, const vec4& vec);
+inline std::ostream& operator <<(std::ostream& stream, const vec4& vec);
 
 /**
  * @brief Reads four values from the input stream and assigns them to the x, y, z and w components
@@ -135,74 +149,379 @@ std::ostream& operator <<(std::ostream& stream, const vec4& vec);
  * @param vec The vec4 to assign the read values to.
  * @return A reference to the input stream after reading the values and assigning them to vec4.
  */
-std::istream& operator >>(std::istream& stream, vec4& vec);
+inline std::istream& operator >>(std::istream& stream, vec4& vec);
 
 /** @brief Adds a vec4's components to another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise sum of the two vec4.
  */
-vec4 operator +(const vec4& left, const vec4& right);
+constexpr vec4 operator +(const vec4& left, const vec4& right);
 
 /** @brief Subtracts a vec4's components by another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise subtraction of the first vec4 by the second.
  */
-vec4 operator -(const vec4& left, const vec4& right);
+constexpr vec4 operator -(const vec4& left, const vec4& right);
 
 /** @brief Multiplies a vec4's components by another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise product of the two vec4.
  */
-vec4 operator *(const vec4& left, const vec4& right);
+constexpr vec4 operator *(const vec4& left, const vec4& right);
 
 /** @brief Divides a vec4's components by another's.
  *  @param left The left operand.
  *  @param right The right operand.
  *  @return The component-wise division of the first vec4 by the second.
  */
-vec4 operator /(const vec4& left, const vec4& right);
+constexpr vec4 operator /(const vec4& left, const vec4& right);
 
 /** @brief Adds a value to each of a vec4's components.
  *  @param vec The vec4.
  *  @param value The value.
  *  @return The component-wise sum of a vec4 by a value.
  */
-vec4 operator +(const vec4& vec, float value);
+constexpr vec4 operator +(const vec4& vec, float value);
 
 /** @brief Subtracts each of a vec4's components by a value.
  *  @param vec The vec4.
  *  @param value The value.
  *  @return The component-wise subtraction of a vec4 by a value.
  */
-vec4 operator -(const vec4& vec, float value);
+constexpr vec4 operator -(const vec4& vec, float value);
 
 /** @brief Multiplies each of a vec4's components by a value.
  *  @param vec The vec4.
  *  @param value The value.
  *  @return The component-wise product of a vec4 by a value.
  */
-vec4 operator *(const vec4& vec, float value);
+constexpr vec4 operator *(const vec4& vec, float value);
 
 /** @brief Multiplies each of a vec4's components by a value.
  *  @param value The value.
  *  @param vec The vec4.
  *  @return The component-wise product of a vec4 by a value.
  */
-vec4 operator *(float value, const vec4& vec);
+constexpr vec4 operator *(float value, const vec4& vec);
 
 /** @brief Divides each of a vec4's components by a value.
  *  @param vec The vec4.
  *  @param value The value.
  *  @return The component-wise division of a vec4 by a value.
  */
-vec4 operator /(const vec4& vec, float value);
+constexpr vec4 operator /(const vec4& vec, float value);
 
 /**
  * @brief Multiplies all of a vec4's components by -1.
  *  @param vec The vec4.
  *  @return The component-wise product of a vec4 by -1.
  */
-vec4 operator -(const vec4& vec);
+constexpr vec4 operator -(const vec4& vec);
+
+/* ---- Implementation ---- */
+
+#ifdef MATHS_SIMD_SSE4
+constexpr vec4::vec4() : x(), y(), z(), w() {
+    if !consteval { simd = _mm_setzero_ps(); }
+}
+
+/* At runtime the register is built directly, going through the scalar members would make the next
+ * packed load wait on 4 separate stores */
+constexpr vec4::vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {
+    if !consteval { simd = _mm_setr_ps(x, y, z, w); }
+}
+
+constexpr vec4::vec4(float value) : x(value), y(value), z(value), w(value) {
+    if !consteval { simd = _mm_set1_ps(value); }
+}
+
+inline vec4::vec4(__m128 simd) : simd(simd) { }
+#else
+constexpr vec4::vec4() : x(), y(), z(), w() { }
+
+constexpr vec4::vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) { }
+
+constexpr vec4::vec4(float value) : x(value), y(value), z(value), w(value) { }
+#endif
+
+constexpr vec4& vec4::operator+=(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_add_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x += vec.x;
+    y += vec.y;
+    z += vec.z;
+    w += vec.w;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator-=(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_sub_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x -= vec.x;
+    y -= vec.y;
+    z -= vec.z;
+    w -= vec.w;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator*=(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_mul_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x *= vec.x;
+    y *= vec.y;
+    z *= vec.z;
+    w *= vec.w;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator/=(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_div_ps(simd, vec.simd);
+        return *this;
+    }
+#endif
+
+    x /= vec.x;
+    y /= vec.y;
+    z /= vec.z;
+    w /= vec.w;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator+=(float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_add_ps(simd, _mm_set1_ps(value));
+        return *this;
+    }
+#endif
+
+    x += value;
+    y += value;
+    z += value;
+    w += value;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator-=(float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_sub_ps(simd, _mm_set1_ps(value));
+        return *this;
+    }
+#endif
+
+    x -= value;
+    y -= value;
+    z -= value;
+    w -= value;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator*=(float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_mul_ps(simd, _mm_set1_ps(value));
+        return *this;
+    }
+#endif
+
+    x *= value;
+    y *= value;
+    z *= value;
+    w *= value;
+
+    return *this;
+}
+
+constexpr vec4& vec4::operator/=(float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval {
+        simd = _mm_div_ps(simd, _mm_set1_ps(value));
+        return *this;
+    }
+#endif
+
+    x /= value;
+    y /= value;
+    z /= value;
+    w /= value;
+
+    return *this;
+}
+
+constexpr bool vec4::operator==(const vec4& other) const {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return (_mm_movemask_ps(_mm_cmpeq_ps(simd, other.simd)) & 0xF) == 0xF; }
+#endif
+
+    return x == other.x && y == other.y && z == other.z && w == other.w;
+}
+
+constexpr bool vec4::operator!=(const vec4& other) const {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return (_mm_movemask_ps(_mm_cmpneq_ps(simd, other.simd)) & 0xF) != 0; }
+#endif
+
+    return x != other.x || y != other.y || z != other.z || w != other.w;
+}
+
+inline std::ostream& operator<<(std::ostream& stream, const vec4& vec) {
+    stream << "( " << vec.x << " ; " << vec.y << " ; " << vec.z << " ; " << vec.w << " )";
+    return stream;
+}
+
+inline std::istream& operator>>(std::istream& stream, vec4& vec) {
+    stream >> vec.x >> vec.y >> vec.z >> vec.w;
+    return stream;
+}
+
+constexpr vec4 operator+(const vec4& left, const vec4& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_add_ps(left.simd, right.simd)); }
+#endif
+
+    return vec4(
+        left.x + right.x,
+        left.y + right.y,
+        left.z + right.z,
+        left.w + right.w
+    );
+}
+
+constexpr vec4 operator-(const vec4& left, const vec4& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_sub_ps(left.simd, right.simd)); }
+#endif
+
+    return vec4(
+        left.x - right.x,
+        left.y - right.y,
+        left.z - right.z,
+        left.w - right.w
+    );
+}
+
+constexpr vec4 operator*(const vec4& left, const vec4& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_mul_ps(left.simd, right.simd)); }
+#endif
+
+    return vec4(
+        left.x * right.x,
+        left.y * right.y,
+        left.z * right.z,
+        left.w * right.w
+    );
+}
+
+constexpr vec4 operator/(const vec4& left, const vec4& right) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_div_ps(left.simd, right.simd)); }
+#endif
+
+    return vec4(
+        left.x / right.x,
+        left.y / right.y,
+        left.z / right.z,
+        left.w / right.w
+    );
+}
+
+constexpr vec4 operator+(const vec4& vec, float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_add_ps(vec.simd, _mm_set1_ps(value))); }
+#endif
+
+    return vec4(
+        vec.x + value,
+        vec.y + value,
+        vec.z + value,
+        vec.w + value
+    );
+}
+
+constexpr vec4 operator-(const vec4& vec, float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_sub_ps(vec.simd, _mm_set1_ps(value))); }
+#endif
+
+    return vec4(
+        vec.x - value,
+        vec.y - value,
+        vec.z - value,
+        vec.w - value
+    );
+}
+
+constexpr vec4 operator*(const vec4& vec, float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_mul_ps(vec.simd, _mm_set1_ps(value))); }
+#endif
+
+    return vec4(
+        vec.x * value,
+        vec.y * value,
+        vec.z * value,
+        vec.w * value
+    );
+}
+
+constexpr vec4 operator*(float value, const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_mul_ps(_mm_set1_ps(value), vec.simd)); }
+#endif
+
+    return vec4(
+        value * vec.x,
+        value * vec.y,
+        value * vec.z,
+        value * vec.w
+    );
+}
+
+constexpr vec4 operator/(const vec4& vec, float value) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_div_ps(vec.simd, _mm_set1_ps(value))); }
+#endif
+
+    return vec4(
+        vec.x / value,
+        vec.y / value,
+        vec.z / value,
+        vec.w / value
+    );
+}
+
+constexpr vec4 operator-(const vec4& vec) {
+#ifdef MATHS_SIMD_SSE4
+    if !consteval { return vec4(_mm_xor_ps(vec.simd, _mm_set1_ps(-0.0f))); }
+#endif
+
+    return vec4(-vec.x, -vec.y, -vec.z, -vec.w);
+}
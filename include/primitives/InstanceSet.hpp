@@ -0,0 +1,165 @@
+/***************************************************************************************************
+ * @file  InstanceSet.hpp
+ * @brief Declaration of the InstanceSet class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Hit.hpp"
+#include "Ray.hpp"
+#include "ThreadPool.hpp"
+#include "acceleration/AABB.hpp"
+#include "acceleration/BVH.hpp"
+#include "acceleration/WideBVH.hpp"
+#include "maths/mat4.hpp"
+#include "primitives/TriangleMesh.hpp"
+
+/**
+ * @class InstanceSet
+ * @brief Instanced triangle meshes. Every mesh is stored once with its own bottom-level BVH, and an
+ * instance only holds the index of its mesh and its transform, so that the memory grows with the
+ * unique meshes rather than with the instances. A top-level BVH over the world bounds of the
+ * instances finds the instances a ray may hit, and the ray is transformed into the object space of
+ * each of them to traverse its mesh.
+ */
+class InstanceSet {
+public:
+    /**
+     * @struct Instance
+     * @brief A placement of a mesh in the world.
+     */
+    struct Instance {
+        std::uint32_t mesh;      ///< The index of the mesh.
+        mat4 object_to_world;    ///< The transform of the instance.
+        mat4 world_to_object;    ///< The inverse of the transform of the instance.
+        std::uint32_t material;  ///< The index of the material of the instance in its scene.
+    };
+
+    /**
+     * @brief Adds a mesh that can then be instanced. Its BVH is built with the top-level one.
+     * @param mesh The mesh.
+     * @return The index of the mesh.
+     */
+    std::uint32_t add_mesh(TriangleMesh mesh);
+
+    /**
+     * @brief Adds an instance of a mesh.
+     * @param mesh The index of the mesh, given by add_mesh, or std::out_of_range is thrown.
+     * @param transform The affine transform from the object space of the mesh to the world, which
+     * must be invertible with a finite inverse or std::invalid_argument is thrown.
+     * @param material The index of the material of the instance in its scene.
+     */
+    void add_instance(std::uint32_t mesh, const mat4& transform, std::uint32_t material = 0);
+
+    /**
+     * @brief Gives the number of instances.
+     * @return The number of instances.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Gives the meshes.
+     * @return The meshes.
+     */
+    const std::vector<TriangleMesh>& get_meshes() const;
+
+    /**
+     * @brief Gives an instance.
+     * @param instance The index of the instance.
+     * @return The instance.
+     */
+    const Instance& get_instance(std::size_t instance) const;
+
+    /**
+     * @brief Gives the world bounds of an instance, which contain the transformed bounds of its mesh.
+     * @param instance The index of the instance.
+     * @return The bounds.
+     */
+    AABB get_bounds(std::size_t instance) const;
+
+    /**
+     * @brief Builds the BVHs of the meshes that do not have one yet, then the top-level BVH used by
+     * trace and occluded. Must be called again after adding instances.
+     * @param builder The algorithm building the BVHs.
+     */
+    void build_bvh(BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Builds the BVHs of the meshes that do not have one yet, then the top-level BVH used by
+     * trace and occluded, in parallel. Must be called again after adding instances.
+     * @param pool The pool running the builds.
+     * @param builder The algorithm building the BVHs.
+     */
+    void build_bvh(ThreadPool& pool, BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Gives the top-level BVH over the instances.
+     * @return The BVH.
+     */
+    const BVH& get_bvh() const;
+
+    /**
+     * @brief Calculates the memory used by the meshes, the instances and the BVHs.
+     * @return The size in bytes.
+     */
+    std::size_t get_memory_usage() const;
+
+    /**
+     * @brief Intersects a ray with a single instance, traversing its mesh in object space.
+     * @param instance The index of the instance.
+     * @param ray The ray, in world space.
+     * @param hit The closest hit so far, updated with the world distance, the triangle and the
+     * instance if the instance is hit closer.
+     * @return Whether the instance was hit closer.
+     */
+    bool intersect(std::uint32_t instance, const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Finds the closest instance hit by a ray by traversing the top-level BVH.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer instance is hit.
+     * @return Whether a closer instance was hit.
+     */
+    bool trace(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Tests if a ray hits any instance before a given distance by traversing the top-level
+     * BVH.
+     * @param ray The ray.
+     * @param max_distance The distance after which hits are ignored.
+     * @return Whether an instance was hit.
+     */
+    bool occluded(const Ray& ray, float max_distance) const;
+
+    /**
+     * @brief Gives the normal of a hit instance, facing the ray.
+     * @param ray The ray that hit the instance.
+     * @param hit The hit.
+     * @return The unit geometric normal in world space.
+     */
+    vec3 get_normal(const Ray& ray, const Hit& hit) const;
+
+private:
+    /**
+     * @brief Transforms a ray into the object space of an instance. Its direction is normalized
+     * again, so object distances are world distances multiplied by the length the transform gives
+     * to the world direction.
+     * @param instance The instance.
+     * @param ray The ray, in world space.
+     * @param scale Where the object length of a unit world step along the ray is written.
+     * @return The ray in object space.
+     */
+    static Ray to_object_space(const Instance& instance, const Ray& ray, float& scale);
+
+    std::vector<AABB> get_all_bounds() const;
+
+    std::vector<TriangleMesh> meshes;
+    std::vector<Instance> instances;
+
+    BVH bvh;
+    WideBVH<wide_bvh_width> wide_bvh;
+};
@@ -0,0 +1,162 @@
+/***************************************************************************************************
+ * @file  SphereSet.hpp
+ * @brief Declaration of the SphereSet class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "Hit.hpp"
+#include "Ray.hpp"
+#include "ThreadPool.hpp"
+#include "acceleration/AABB.hpp"
+#include "acceleration/BVH.hpp"
+#include "acceleration/WideBVH.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @class SphereSet
+ * @brief A set of spheres stored as a structure of arrays. The arrays are aligned and padded to a
+ * multiple of 8 so that a ray can be tested against 8 spheres with each AVX instruction.
+ */
+class SphereSet {
+public:
+    static constexpr std::size_t batch_size = 8; ///< The number of spheres tested at once.
+
+    /**
+     * @brief Adds a sphere to the set.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     * @param material The index of the material of the sphere in its scene.
+     */
+    void add(const vec3& center, float radius, std::uint32_t material = 0);
+
+    /**
+     * @brief Gives the number of spheres.
+     * @return The number of spheres.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Gives the center of a sphere.
+     * @param sphere The index of the sphere.
+     * @return The center.
+     */
+    vec3 get_center(std::size_t sphere) const;
+
+    /**
+     * @brief Gives the radius of a sphere.
+     * @param sphere The index of the sphere.
+     * @return The radius.
+     */
+    float get_radius(std::size_t sphere) const;
+
+    /**
+     * @brief Gives the material of a sphere.
+     * @param sphere The index of the sphere.
+     * @return The index of the material in the scene of the sphere.
+     */
+    std::uint32_t get_material(std::size_t sphere) const;
+
+    /**
+     * @brief Gives the bounds of a sphere.
+     * @param sphere The index of the sphere.
+     * @return The bounds.
+     */
+    AABB get_bounds(std::size_t sphere) const;
+
+    /**
+     * @brief Builds the BVH and the wide BVH used by trace and occluded. Must be called again after
+     * adding spheres.
+     * @param builder The algorithm building the BVH.
+     */
+    void build_bvh(BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Builds the BVH and the wide BVH used by trace and occluded in parallel. Must be called
+     * again after adding spheres.
+     * @param pool The pool running the build.
+     * @param builder The algorithm building the BVH.
+     */
+    void build_bvh(ThreadPool& pool, BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Gives the BVH of the spheres.
+     * @return The BVH.
+     */
+    const BVH& get_bvh() const;
+
+    /**
+     * @brief Gives the wide BVH collapsed from the BVH, which trace and occluded traverse.
+     * @return The wide BVH.
+     */
+    const WideBVH<wide_bvh_width>& get_wide_bvh() const;
+
+    /**
+     * @brief Finds the closest sphere hit by a ray, testing the spheres in batches of 8.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer sphere is hit.
+     * @return Whether a closer sphere was hit.
+     */
+    bool intersect(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Finds the closest sphere hit by a ray, testing the spheres one by one. This is the
+     * reference the batched version is compared against.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer sphere is hit.
+     * @return Whether a closer sphere was hit.
+     */
+    bool intersect_reference(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Intersects a ray with a single sphere.
+     * @param sphere The index of the sphere.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if the sphere is hit closer.
+     * @return Whether the sphere was hit closer.
+     */
+    bool intersect(std::uint32_t sphere, const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Finds the closest sphere hit by a ray by traversing the wide BVH.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer sphere is hit.
+     * @return Whether a closer sphere was hit.
+     */
+    bool trace(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Tests if a ray hits any sphere before a given distance by traversing the wide BVH.
+     * @param ray The ray.
+     * @param max_distance The distance after which hits are ignored.
+     * @return Whether a sphere was hit.
+     */
+    bool occluded(const Ray& ray, float max_distance) const;
+
+    /**
+     * @brief Gives the normal at a hit point.
+     * @param ray The ray that hit the sphere.
+     * @param hit The hit.
+     * @return The outward unit normal.
+     */
+    vec3 get_normal(const Ray& ray, const Hit& hit) const;
+
+private:
+    std::vector<AABB> get_all_bounds() const;
+
+    std::size_t count = 0;
+
+    AlignedVector<float> center_x;
+    AlignedVector<float> center_y;
+    AlignedVector<float> center_z;
+    AlignedVector<float> radius;
+    std::vector<std::uint32_t> materials;
+
+    BVH bvh;
+    WideBVH<wide_bvh_width> wide_bvh;
+};
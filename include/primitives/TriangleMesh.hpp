@@ -0,0 +1,236 @@
+/***************************************************************************************************
+ * @file  TriangleMesh.hpp
+ * @brief Declaration of the TriangleMesh class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AlignedAllocator.hpp"
+#include "Hit.hpp"
+#include "Ray.hpp"
+#include "ThreadPool.hpp"
+#include "acceleration/AABB.hpp"
+#include "acceleration/BVH.hpp"
+#include "acceleration/WideBVH.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @class TriangleMesh
+ * @brief An indexed triangle mesh. Besides the vertices and indices, every triangle's first vertex
+ * and two edges are kept as a structure of arrays padded to a multiple of 8, so that a ray can be
+ * tested against 8 triangles at once with AVX2. The batched and scalar kernels perform the exact
+ * same operations, so they find bit-for-bit identical hits.
+ */
+class TriangleMesh {
+public:
+    static constexpr std::size_t batch_size = 8; ///< The number of triangles tested at once.
+
+    TriangleMesh() = default;
+
+    /**
+     * @brief Constructs a mesh.
+     * @param positions The positions of the vertices.
+     * @param indices The indices of the vertices of each triangle, 3 per triangle.
+     */
+    TriangleMesh(std::vector<vec3> positions, std::vector<std::uint32_t> indices);
+
+    /**
+     * @brief Constructs a mesh, filling the triangle arrays in parallel.
+     * @param positions The positions of the vertices.
+     * @param indices The indices of the vertices of each triangle, 3 per triangle.
+     * @param pool The pool filling the triangle arrays.
+     */
+    TriangleMesh(std::vector<vec3> positions, std::vector<std::uint32_t> indices, ThreadPool& pool);
+
+    /**
+     * @brief Reads a mesh written in a cache, with its triangle arrays and its BVHs, so that it can
+     * be traced right away.
+     * @param reader The reader of the cache, whose indices must refer to its positions and whose
+     * BVHs must describe its triangles or a std::runtime_error is thrown.
+     */
+    explicit TriangleMesh(CacheReader& reader);
+
+    /**
+     * @brief Writes the mesh in a cache, with its triangle arrays and its BVHs.
+     * @param writer The writer of the cache.
+     */
+    void save(CacheWriter& writer) const;
+
+    /**
+     * @brief Gives the number of triangles.
+     * @return The number of triangles.
+     */
+    std::size_t get_triangle_count() const;
+
+    /**
+     * @brief Gives the positions of the vertices.
+     * @return The positions.
+     */
+    const std::vector<vec3>& get_positions() const;
+
+    /**
+     * @brief Gives the indices of the vertices of each triangle.
+     * @return The indices, 3 per triangle.
+     */
+    const std::vector<std::uint32_t>& get_indices() const;
+
+    /**
+     * @brief Gives a vertex of a triangle.
+     * @param triangle The index of the triangle.
+     * @param vertex The index of the vertex in the triangle, between 0 and 2.
+     * @return The position of the vertex.
+     */
+    const vec3& get_vertex(std::size_t triangle, unsigned int vertex) const;
+
+    /**
+     * @brief Gives the bounds of a triangle.
+     * @param triangle The index of the triangle.
+     * @return The bounds.
+     */
+    AABB get_bounds(std::size_t triangle) const;
+
+    /**
+     * @brief Builds the BVH and the wide BVH used by trace and occluded.
+     * @param builder The algorithm building the BVH, also used when set_positions rebuilds it.
+     */
+    void build_bvh(BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Builds the BVH and the wide BVH used by trace and occluded in parallel, including the bounds of the
+     * triangles.
+     * @param pool The pool running the build.
+     * @param builder The algorithm building the BVH, also used when set_positions rebuilds it.
+     */
+    void build_bvh(ThreadPool& pool, BVH::Builder builder = BVH::Builder::SAH);
+
+    /**
+     * @brief Gives the BVH of the triangles.
+     * @return The BVH.
+     */
+    const BVH& get_bvh() const;
+
+    /**
+     * @brief Gives the wide BVH collapsed from the BVH, which trace and occluded traverse.
+     * @return The wide BVH.
+     */
+    const WideBVH<wide_bvh_width>& get_wide_bvh() const;
+
+    /**
+     * @brief Sets the material of the mesh, which is not written in caches.
+     * @param material The index of the material in the scene of the mesh.
+     */
+    void set_material(std::uint32_t material);
+
+    /**
+     * @brief Gives the material of the mesh.
+     * @return The index of the material in the scene of the mesh.
+     */
+    std::uint32_t get_material() const;
+
+    /**
+     * @brief Moves the vertices of the mesh, for a new frame of an animation. The connectivity does
+     * not change, so the BVHs are refitted to the new triangles rather than built again, unless the
+     * refitted BVH has become too poor.
+     * @param positions The new positions, as many as the current ones, or std::invalid_argument is
+     * thrown and the mesh left unchanged.
+     * @return Whether the BVHs had to be built again.
+     */
+    bool set_positions(std::vector<vec3> positions);
+
+    /**
+     * @brief Moves the vertices of the mesh, for a new frame of an animation, refitting the BVHs in
+     * parallel.
+     * @param positions The new positions, as many as the current ones, or std::invalid_argument is
+     * thrown and the mesh left unchanged.
+     * @param pool The pool running the refit.
+     * @return Whether the BVHs had to be built again.
+     */
+    bool set_positions(std::vector<vec3> positions, ThreadPool& pool);
+
+    /**
+     * @brief Calculates the memory used by the vertices, the triangle arrays and the BVHs.
+     * @return The size in bytes.
+     */
+    std::size_t get_memory_usage() const;
+
+    /**
+     * @brief Finds the closest triangle hit by a ray, testing the triangles in batches of 8.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer triangle is hit.
+     * @return Whether a closer triangle was hit.
+     */
+    bool intersect(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Finds the closest triangle hit by a ray, testing the triangles one by one from the
+     * indexed vertices. This is the reference the batched version is compared against.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer triangle is hit.
+     * @return Whether a closer triangle was hit.
+     */
+    bool intersect_reference(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Intersects a ray with a single triangle.
+     * @param triangle The index of the triangle.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if the triangle is hit closer.
+     * @return Whether the triangle was hit closer.
+     */
+    bool intersect(std::uint32_t triangle, const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Finds the closest triangle hit by a ray by traversing the wide BVH.
+     * @param ray The ray.
+     * @param hit The closest hit so far, updated if a closer triangle is hit.
+     * @return Whether a closer triangle was hit.
+     */
+    bool trace(const Ray& ray, Hit& hit) const;
+
+    /**
+     * @brief Tests if a ray hits any triangle before a given distance by traversing the wide BVH.
+     * @param ray The ray.
+     * @param max_distance The distance after which hits are ignored.
+     * @return Whether a triangle was hit.
+     */
+    bool occluded(const Ray& ray, float max_distance) const;
+
+    /**
+     * @brief Gives the normal of a hit triangle, facing the ray.
+     * @param ray The ray that hit the triangle.
+     * @param hit The hit.
+     * @return The unit geometric normal.
+     */
+    vec3 get_normal(const Ray& ray, const Hit& hit) const;
+
+private:
+    bool update_positions(std::vector<vec3> positions, ThreadPool* pool);
+
+    void build_triangle_arrays(ThreadPool* pool);
+    void fill_triangle(std::size_t triangle);
+
+    std::vector<AABB> get_all_bounds(ThreadPool* pool) const;
+
+    std::vector<vec3> positions;
+    std::vector<std::uint32_t> indices;
+
+    std::size_t triangle_count = 0;
+    std::uint32_t material = 0;
+
+    AlignedVector<float> vertex_x;
+    AlignedVector<float> vertex_y;
+    AlignedVector<float> vertex_z;
+    AlignedVector<float> edge1_x;
+    AlignedVector<float> edge1_y;
+    AlignedVector<float> edge1_z;
+    AlignedVector<float> edge2_x;
+    AlignedVector<float> edge2_y;
+    AlignedVector<float> edge2_z;
+
+    BVH bvh;
+    WideBVH<wide_bvh_width> wide_bvh;
+};
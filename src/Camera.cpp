@@ -0,0 +1,98 @@
+/***************************************************************************************************
+ * @file  Camera.cpp
+ * @brief Implementation of the Camera class
+ **************************************************************************************************/
+
+#include "Camera.hpp"
+
+#include <cmath>
+#include <numbers>
+
+#include "maths/geometry.hpp"
+
+Camera::Camera(const vec3& position, const vec3& look_at, const vec3& up, float fov, unsigned int width,
+               unsigned int height)
+    : position(position), aspect(static_cast<float>(width) / height) {
+    /* Basis */
+    w = normalize(position - look_at);
+    u = normalize(cross(up, w));
+    v = cross(w, u);
+
+    /* Viewport at a distance of 1 */
+    float half_height = std::tan(0.5f * fov * std::numbers::pi_v<float> / 180.0f);
+    float half_width = aspect * half_height;
+
+    bottom_left = -w - half_width * u - half_height * v;
+    pixel_delta_u = (2.0f * half_width / width) * u;
+    pixel_delta_v = (2.0f * half_height / height) * v;
+    packet_delta_u = static_cast<float>(RayPacket8::size) * pixel_delta_u;
+
+    for(unsigned int lane = 0 ; lane < RayPacket8::size ; ++lane) {
+        vec3 lane_delta = static_cast<float>(lane) * pixel_delta_u;
+        lane_delta_x[lane] = lane_delta.x;
+        lane_delta_y[lane] = lane_delta.y;
+        lane_delta_z[lane] = lane_delta.z;
+    }
+}
+
+vec3 Camera::get_direction(float x, float y) const {
+    return bottom_left + x * pixel_delta_u + y * pixel_delta_v;
+}
+
+Ray Camera::get_ray(float x, float y) const {
+    return Ray(position, get_direction(x, y));
+}
+
+void Camera::generate(RayPacket8& packet, const vec3& direction) const {
+#ifdef MATHS_SIMD_AVX2
+    __m256 direction_x = _mm256_add_ps(_mm256_set1_ps(direction.x), _mm256_load_ps(lane_delta_x));
+    __m256 direction_y = _mm256_add_ps(_mm256_set1_ps(direction.y), _mm256_load_ps(lane_delta_y));
+    __m256 direction_z = _mm256_add_ps(_mm256_set1_ps(direction.z), _mm256_load_ps(lane_delta_z));
+
+    __m256 length = _mm256_sqrt_ps(_mm256_fmadd_ps(
+        direction_x, direction_x,
+        _mm256_fmadd_ps(direction_y, direction_y, _mm256_mul_ps(direction_z, direction_z))
+    ));
+    __m256 inverse_length = _mm256_div_ps(_mm256_set1_ps(1.0f), length);
+
+    _mm256_store_ps(packet.direction_x, _mm256_mul_ps(direction_x, inverse_length));
+    _mm256_store_ps(packet.direction_y, _mm256_mul_ps(direction_y, inverse_length));
+    _mm256_store_ps(packet.direction_z, _mm256_mul_ps(direction_z, inverse_length));
+
+    _mm256_store_ps(packet.origin_x, _mm256_set1_ps(position.x));
+    _mm256_store_ps(packet.origin_y, _mm256_set1_ps(position.y));
+    _mm256_store_ps(packet.origin_z, _mm256_set1_ps(position.z));
+#else
+    for(unsigned int lane = 0 ; lane < RayPacket8::size ; ++lane) {
+        float direction_x = direction.x + lane_delta_x[lane];
+        float direction_y = direction.y + lane_delta_y[lane];
+        float direction_z = direction.z + lane_delta_z[lane];
+        float inverse_length = 1.0f / std::sqrt(direction_x * direction_x + direction_y * direction_y
+                                                + direction_z * direction_z);
+
+        packet.direction_x[lane] = direction_x * inverse_length;
+        packet.direction_y[lane] = direction_y * inverse_length;
+        packet.direction_z[lane] = direction_z * inverse_length;
+
+        packet.origin_x[lane] = position.x;
+        packet.origin_y[lane] = position.y;
+        packet.origin_z[lane] = position.z;
+    }
+#endif
+}
+
+const vec3& Camera::get_position() const {
+    return position;
+}
+
+const vec3& Camera::get_pixel_delta_u() const {
+    return pixel_delta_u;
+}
+
+const vec3& Camera::get_packet_delta_u() const {
+    return packet_delta_u;
+}
+
+float Camera::get_aspect() const {
+    return aspect;
+}
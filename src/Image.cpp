@@ -5,44 +5,170 @@
 
 #include "Image.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "Profiler.hpp"
 #include "stb_image_write.h"
 
+namespace {
+    /**
+     * @brief Quantises the pixels of an image to 8 bits and writes them in a PNG file.
+     * @param image The image.
+     * @param path The path of the file.
+     */
+    void write_png(const Image& image, const std::string& path) {
+        std::vector<uint8_t> normalized_data(static_cast<std::size_t>(image.width) * image.height * 3);
+
+        {
+            PROFILE_PHASE(QUANTISE);
+            uint8_t* output = normalized_data.data();
+
+            /* PNG rows go from top to bottom */
+            for(unsigned int j = image.height ; j-- > 0 ;) {
+                for(const vec3& pixel : image.get_row(j)) {
+                    *output++ = std::clamp(255.0f * pixel.r, 0.0f, 255.0f);
+                    *output++ = std::clamp(255.0f * pixel.g, 0.0f, 255.0f);
+                    *output++ = std::clamp(255.0f * pixel.b, 0.0f, 255.0f);
+                }
+            }
+        }
+
+        PROFILE_PHASE(ENCODE);
+        if(!stbi_write_png(path.c_str(), image.width, image.height, 3, normalized_data.data(), image.width * 3)) {
+            throw std::runtime_error("Failed to write image '" + path + '\'');
+        }
+    }
+
+    /**
+     * @brief Writes the pixels of an image in a PFM file, as they are. The rows of a PFM file go from
+     * bottom to top like those of the image, so without the padding of SIMD vec3s the pixel buffer
+     * is written in a single call.
+     * @param image The image.
+     * @param path The path of the file.
+     */
+    void write_pfm(const Image& image, const std::string& path) {
+        PROFILE_PHASE(ENCODE);
+
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+        if(file == nullptr) { throw std::runtime_error("Failed to write image '" + path + '\''); }
+
+        /* A negative scale tells the floats are little-endian */
+        const char* scale = std::endian::native == std::endian::little ? "-1.0" : "1.0";
+        bool written = std::fprintf(file.get(), "PF\n%u %u\n%s\n", image.width, image.height, scale) > 0;
+
+        if constexpr(sizeof(vec3) == 3 * sizeof(float)) {
+            std::size_t size = static_cast<std::size_t>(image.width) * image.height;
+            written = written && std::fwrite(image.data, sizeof(vec3), size, file.get()) == size;
+        } else {
+            std::vector<float> row(static_cast<std::size_t>(image.width) * 3);
+            for(unsigned int j = 0 ; j < image.height && written ; ++j) {
+                float* output = row.data();
+                for(const vec3& pixel : image.get_row(j)) {
+                    *output++ = pixel.r;
+                    *output++ = pixel.g;
+                    *output++ = pixel.b;
+                }
+
+                written = std::fwrite(row.data(), sizeof(float), row.size(), file.get()) == row.size();
+            }
+        }
+
+        if(!written || std::fclose(file.release()) != 0) {
+            throw std::runtime_error("Failed to write image '" + path + '\'');
+        }
+    }
+
+    /**
+     * @brief Writes the pixels of an image in a Radiance HDR file.
+     * @param image The image.
+     * @param path The path of the file.
+     */
+    void write_hdr(const Image& image, const std::string& path) {
+        std::vector<float> linear_data(static_cast<std::size_t>(image.width) * image.height * 3);
+
+        {
+            PROFILE_PHASE(QUANTISE);
+            float* output = linear_data.data();
+
+            /* HDR rows go from top to bottom, and negative values cannot be encoded */
+            for(unsigned int j = image.height ; j-- > 0 ;) {
+                for(const vec3& pixel : image.get_row(j)) {
+                    *output++ = std::max(pixel.r, 0.0f);
+                    *output++ = std::max(pixel.g, 0.0f);
+                    *output++ = std::max(pixel.b, 0.0f);
+                }
+            }
+        }
+
+        PROFILE_PHASE(ENCODE);
+        if(!stbi_write_hdr(path.c_str(), image.width, image.height, 3, linear_data.data())) {
+            throw std::runtime_error("Failed to write image '" + path + '\'');
+        }
+    }
+}
+
 Image::Image(unsigned int width, unsigned int height)
     : width(width), height(height), data(nullptr) {
-    data = new vec3*[width];
-    for(unsigned int i = 0 ; i < width ; ++i) { data[i] = new vec3[height]; }
+    std::size_t size = static_cast<std::size_t>(width) * height;
+    data = static_cast<vec3*>(::operator new[](size * sizeof(vec3), std::align_val_t(alignment)));
+    std::uninitialized_value_construct_n(data, size);
 }
 
+Image::Image(Image&& image) noexcept
+    : width(image.width), height(image.height), data(std::exchange(image.data, nullptr)) { }
+
 Image::~Image() {
-    for(unsigned int i = 0 ; i < width ; ++i) { delete[] data[i]; }
-    delete[] data;
+    ::operator delete[](data, std::align_val_t(alignment));
 }
 
-vec3& Image::operator()(unsigned int row, unsigned int column) {
-    return data[row][column];
+vec3& Image::operator()(unsigned int column, unsigned int row) {
+    return data[static_cast<std::size_t>(row) * width + column];
 }
 
-const vec3& Image::operator()(unsigned int row, unsigned int column) const {
-    return data[row][column];
+const vec3& Image::operator()(unsigned int column, unsigned int row) const {
+    return data[static_cast<std::size_t>(row) * width + column];
 }
 
-void Image::write() const {
-    std::vector<uint8_t> normalized_data;
-    normalized_data.reserve(width * height * 3);
+std::span<vec3> Image::get_row(unsigned int row) {
+    return std::span<vec3>(data + static_cast<std::size_t>(row) * width, width);
+}
 
-    for(unsigned int j = 0 ; j < height ; ++j) {
-        for(unsigned int i = 0 ; i < width ; ++i) {
-            const vec3& pixel = data[i][j];
+std::span<const vec3> Image::get_row(unsigned int row) const {
+    return std::span<const vec3>(data + static_cast<std::size_t>(row) * width, width);
+}
 
-            normalized_data.push_back(std::clamp(255.0f * pixel.r, 0.0f, 255.0f));
-            normalized_data.push_back(std::clamp(255.0f * pixel.g, 0.0f, 255.0f));
-            normalized_data.push_back(std::clamp(255.0f * pixel.b, 0.0f, 255.0f));
-        }
-    }
+std::span<vec3> Image::get_tile_row(const Tile& tile, unsigned int row) {
+    return get_row(row).subspan(tile.x_min, tile.x_max - tile.x_min);
+}
 
-    stbi_flip_vertically_on_write(true);
-    stbi_write_png("data/img.png", width, height, 3, normalized_data.data(), width * 3);
+Image::Format Image::get_format(const std::string& path) {
+    const std::string extension = std::filesystem::path(path).extension().string();
+    if(extension == ".png") { return Format::PNG; }
+    if(extension == ".pfm") { return Format::PFM; }
+    if(extension == ".hdr") { return Format::HDR; }
+
+    throw std::runtime_error("Failed to write image '" + path + "', its extension is not .png, .pfm or .hdr");
+}
+
+void Image::write(const std::string& path) const {
+    switch(get_format(path)) {
+        case Format::PNG:
+            write_png(*this, path);
+            break;
+        case Format::PFM:
+            write_pfm(*this, path);
+            break;
+        case Format::HDR:
+            write_hdr(*this, path);
+            break;
+    }
 }
@@ -0,0 +1,73 @@
+/***************************************************************************************************
+ * @file  ImageWriter.cpp
+ * @brief Implementation of the ImageWriter class
+ **************************************************************************************************/
+
+#include "ImageWriter.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ImageWriter::ImageWriter(std::size_t max_queued)
+    : max_queued(std::max<std::size_t>(max_queued, 1)), writing(false), stopping(false),
+      thread(&ImageWriter::writer_loop, this) { }
+
+ImageWriter::~ImageWriter() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+    thread.join();
+}
+
+void ImageWriter::submit(Image&& image, std::string path) {
+    {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [this] { return queue.size() < max_queued || exception; });
+        rethrow_exception();
+
+        queue.emplace_back(std::move(image), std::move(path));
+    }
+
+    condition.notify_all();
+}
+
+void ImageWriter::wait() {
+    std::unique_lock lock(mutex);
+    condition.wait(lock, [this] { return (queue.empty() && !writing) || exception; });
+    rethrow_exception();
+}
+
+void ImageWriter::writer_loop() {
+    std::unique_lock lock(mutex);
+
+    while(true) {
+        condition.wait(lock, [this] { return stopping || !queue.empty(); });
+        if(queue.empty()) { return; }
+
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+
+        lock.unlock();
+        condition.notify_all();
+
+        std::exception_ptr thrown;
+        try {
+            job.image.write(job.path);
+        } catch(...) {
+            thrown = std::current_exception();
+        }
+
+        lock.lock();
+        writing = false;
+        if(thrown && !exception) { exception = thrown; }
+        condition.notify_all();
+    }
+}
+
+void ImageWriter::rethrow_exception() {
+    if(exception) { std::rethrow_exception(std::exchange(exception, nullptr)); }
+}
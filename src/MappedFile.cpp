@@ -0,0 +1,62 @@
+/***************************************************************************************************
+ * @file  MappedFile.cpp
+ * @brief Implementation of the MappedFile class
+ **************************************************************************************************/
+
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path)
+    : data(nullptr), size(0) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if(descriptor == -1) { throw std::runtime_error("Failed to open file '" + path + '\''); }
+
+    struct stat status;
+    if(fstat(descriptor, &status) == -1) {
+        close(descriptor);
+        throw std::runtime_error("Failed to read the size of file '" + path + '\'');
+    }
+
+    /* An empty file cannot be mapped, and has nothing to parse anyway */
+    size = status.st_size;
+    if(size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if(mapping == MAP_FAILED) {
+            close(descriptor);
+            throw std::runtime_error("Failed to map file '" + path + '\'');
+        }
+
+        /* Loaders parse chunks spread over the whole file at once, so have it all read ahead */
+        madvise(mapping, size, MADV_WILLNEED);
+        data = static_cast<const char*>(mapping);
+    }
+
+    /* The mapping stays valid once the file is closed */
+    close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+    if(data != nullptr) { munmap(const_cast<char*>(data), size); }
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept
+    : data(std::exchange(file.data, nullptr)), size(std::exchange(file.size, 0)) { }
+
+std::span<const std::byte> MappedFile::get_bytes() const {
+    return { reinterpret_cast<const std::byte*>(data), size };
+}
+
+std::string_view MappedFile::get_text() const {
+    return { data, size };
+}
+
+std::size_t MappedFile::get_size() const {
+    return size;
+}
@@ -0,0 +1,85 @@
+/***************************************************************************************************
+ * @file  Profiler.cpp
+ * @brief Implementation of the Profiler struct
+ **************************************************************************************************/
+
+#include "Profiler.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    /**
+     * @brief The data of every thread that ever used the profiler. It outlives the threads so that
+     * their counts are still part of the report after they exit.
+     */
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Profiler::ThreadData>> threads;
+    };
+
+    Registry& get_registry() {
+        static Registry registry;
+        return registry;
+    }
+
+    const char* const counter_names[Profiler::COUNTER_COUNT]{
+        "rays_cast", "intersections_tested", "pixels_shaded"
+    };
+
+    const char* const phase_names[Profiler::PHASE_COUNT]{
+        "setup", "render", "quantise", "encode"
+    };
+}
+
+Profiler::ThreadData& Profiler::get_thread_data() {
+    thread_local ThreadData* data = nullptr;
+
+    if(data == nullptr) {
+        Registry& registry = get_registry();
+        std::lock_guard lock(registry.mutex);
+        data = registry.threads.emplace_back(std::make_unique<ThreadData>()).get();
+    }
+
+    return *data;
+}
+
+void Profiler::reset() {
+    Registry& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+
+    for(std::unique_ptr<ThreadData>& data : registry.threads) {
+        for(std::atomic<std::uint64_t>& counter : data->counters) { counter = 0; }
+        for(std::atomic<std::uint64_t>& phase : data->phase_nanoseconds) { phase = 0; }
+    }
+}
+
+void Profiler::write_report(std::ostream& stream) {
+    std::uint64_t counters[COUNTER_COUNT]{};
+    std::uint64_t phases[PHASE_COUNT]{};
+    std::size_t thread_count;
+
+    {
+        Registry& registry = get_registry();
+        std::lock_guard lock(registry.mutex);
+        thread_count = registry.threads.size();
+
+        for(const std::unique_ptr<ThreadData>& data : registry.threads) {
+            for(unsigned int i = 0 ; i < COUNTER_COUNT ; ++i) { counters[i] += data->counters[i]; }
+            for(unsigned int i = 0 ; i < PHASE_COUNT ; ++i) { phases[i] += data->phase_nanoseconds[i]; }
+        }
+    }
+
+    stream << "{\n  \"threads\": " << thread_count << ",\n  \"counters\": {\n";
+    for(unsigned int i = 0 ; i < COUNTER_COUNT ; ++i) {
+        stream << "    \"" << counter_names[i] << "\": " << counters[i] << (i + 1 < COUNTER_COUNT ? ",\n" : "\n");
+    }
+
+    stream << "  },\n  \"phases\": {\n";
+    for(unsigned int i = 0 ; i < PHASE_COUNT ; ++i) {
+        stream << "    \"" << phase_names[i] << "\": " << phases[i] * 1e-9 << (i + 1 < PHASE_COUNT ? ",\n" : "\n");
+    }
+
+    stream << "  }\n}\n";
+}
@@ -0,0 +1,24 @@
+/***************************************************************************************************
+ * @file  RayPacket.cpp
+ * @brief Implementation of the RayPacket8 struct
+ **************************************************************************************************/
+
+#include "RayPacket.hpp"
+
+Ray RayPacket8::get_ray(unsigned int lane) const {
+    Ray ray;
+    ray.origin = vec3(origin_x[lane], origin_y[lane], origin_z[lane]);
+    ray.direction = vec3(direction_x[lane], direction_y[lane], direction_z[lane]);
+
+    return ray;
+}
+
+void RayPacket8::set_ray(unsigned int lane, const Ray& ray) {
+    origin_x[lane] = ray.origin.x;
+    origin_y[lane] = ray.origin.y;
+    origin_z[lane] = ray.origin.z;
+    direction_x[lane] = ray.direction.x;
+    direction_y[lane] = ray.direction.y;
+    direction_z[lane] = ray.direction.z;
+}
+
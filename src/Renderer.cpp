@@ -0,0 +1,138 @@
+/***************************************************************************************************
+ * @file  Renderer.cpp
+ * @brief Implementation of the Renderer class
+ **************************************************************************************************/
+
+#include "Renderer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Hit.hpp"
+#include "Profiler.hpp"
+#include "Ray.hpp"
+#include "RayPacket.hpp"
+#include "maths/vec2.hpp"
+
+namespace {
+    template<typename T>
+    T lerp(T value_at_0, T value_at_1, float t) {
+        return (1.0f - t) * value_at_0 + t * value_at_1;
+    }
+
+    vec3 sky(const Scene& scene, float direction_y) {
+        return lerp(scene.sky_bottom, scene.sky_top, 0.5f + 0.5f * direction_y);
+    }
+
+    vec3 shade(const Scene& scene, const Ray& ray) {
+        Hit hit;
+        vec3 normal;
+        std::uint32_t material = 0;
+        bool found = false;
+
+        if(scene.spheres.trace(ray, hit)) {
+            normal = scene.spheres.get_normal(ray, hit);
+            material = scene.spheres.get_material(hit.primitive);
+            found = true;
+        }
+
+        for(const TriangleMesh& mesh : scene.meshes) {
+            if(mesh.trace(ray, hit)) {
+                normal = mesh.get_normal(ray, hit);
+                material = mesh.get_material();
+                found = true;
+            }
+        }
+
+        if(scene.instances.trace(ray, hit)) {
+            normal = scene.instances.get_normal(ray, hit);
+            material = scene.instances.get_instance(hit.instance).material;
+            found = true;
+        }
+
+        if(!found) { return sky(scene, ray.direction.y); }
+
+        vec3 albedo = material < scene.materials.size() ? scene.materials[material].albedo : vec3(1.0f);
+        return albedo * (0.5f * (normal + vec3(1.0f)));
+    }
+
+    /**
+     * @brief Gives the position of a sample in a pixel using the Hammersley point set.
+     * @param sample The index of the sample.
+     * @param samples The number of samples.
+     * @return The offset of the sample from the pixel's corner, in [0, 1)².
+     */
+    vec2 sample_offset(unsigned int sample, unsigned int samples) {
+        unsigned int bits = sample;
+        bits = (bits << 16u) | (bits >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+        return vec2(static_cast<float>(sample) / samples, bits * 0x1p-32f);
+    }
+}
+
+Renderer::Renderer(ThreadPool& pool, unsigned int tile_size)
+    : pool(pool), tile_size(std::max(tile_size, 1u)) { }
+
+void Renderer::render(Image& image, const std::function<void(const Tile&)>& shade_tile) const {
+    for(unsigned int y = 0 ; y < image.height ; y += tile_size) {
+        for(unsigned int x = 0 ; x < image.width ; x += tile_size) {
+            Tile tile(x, y, std::min(x + tile_size, image.width), std::min(y + tile_size, image.height));
+            pool.submit([&shade_tile, tile] { shade_tile(tile); });
+        }
+    }
+
+    pool.wait();
+}
+
+void Renderer::render(const Scene& scene, Image& image) const {
+    const unsigned int samples = std::max(scene.samples, 1u);
+
+    std::vector<vec2> offsets;
+    offsets.reserve(samples);
+    for(unsigned int sample = 0 ; sample < samples ; ++sample) { offsets.push_back(sample_offset(sample, samples)); }
+
+    const Camera& camera = scene.camera;
+
+    render(image, [&](const Tile& tile) {
+        for(unsigned int j = tile.y_min ; j < tile.y_max ; ++j) {
+            std::span<vec3> row = image.get_tile_row(tile, j);
+            std::fill(row.begin(), row.end(), vec3(0.0f));
+
+            for(const vec2& offset : offsets) {
+                vec3 direction = camera.get_direction(tile.x_min + offset.x, j + offset.y);
+                std::size_t i = 0;
+
+                /* Packets of 8 pixels */
+                RayPacket8 packet;
+                for(; i + RayPacket8::size <= row.size() ; i += RayPacket8::size) {
+                    camera.generate(packet, direction);
+                    direction += camera.get_packet_delta_u();
+                    PROFILE_COUNT(RAYS_CAST, RayPacket8::size);
+
+                    for(unsigned int lane = 0 ; lane < RayPacket8::size ; ++lane) {
+                        row[i + lane] += shade(scene, packet.get_ray(lane));
+                    }
+                }
+
+                /* Remaining pixels */
+                for(; i < row.size() ; ++i) {
+                    Ray ray(camera.get_position(), direction);
+                    direction += camera.get_pixel_delta_u();
+                    PROFILE_COUNT(RAYS_CAST, 1);
+
+                    row[i] += shade(scene, ray);
+                }
+            }
+
+            for(vec3& pixel : row) { pixel /= static_cast<float>(samples); }
+
+            PROFILE_COUNT(PIXELS_SHADED, row.size());
+        }
+    });
+}
@@ -0,0 +1,214 @@
+/***************************************************************************************************
+ * @file  ThreadPool.cpp
+ * @brief Implementation of the ThreadPool class
+ **************************************************************************************************/
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local unsigned int current_worker = 0;
+    thread_local unsigned int task_depth = 0; ///< How many tasks are running on this thread's stack.
+}
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+    : queued(0), pending(0), next_worker(0), stopping(false), stats_start(std::chrono::steady_clock::now()) {
+    thread_count = std::max(thread_count, 1u);
+
+    workers.reserve(thread_count);
+    for(unsigned int i = 0 ; i < thread_count ; ++i) { workers.push_back(std::make_unique<Worker>()); }
+
+    threads.reserve(thread_count);
+    for(unsigned int i = 0 ; i < thread_count ; ++i) { threads.emplace_back(&ThreadPool::worker_loop, this, i); }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock lock(mutex);
+        done_condition.wait(lock, [this] { return pending == 0; });
+        stopping = true;
+    }
+
+    wake_condition.notify_all();
+    for(std::thread& thread : threads) { thread.join(); }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned int index = current_pool == this
+                             ? current_worker
+                             : next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+    ++pending;
+
+    {
+        std::lock_guard lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        ++queued;
+    }
+
+    wake_condition.notify_one();
+}
+
+void ThreadPool::wait() {
+    if(current_pool == this) { throw std::logic_error("ThreadPool::wait cannot be called from one of its tasks, use a TaskGroup"); }
+
+    std::unique_lock lock(mutex);
+    done_condition.wait(lock, [this] { return pending == 0; });
+
+    if(exception) {
+        std::exception_ptr thrown = std::exchange(exception, nullptr);
+        std::rethrow_exception(thrown);
+    }
+}
+
+unsigned int ThreadPool::size() const {
+    return workers.size();
+}
+
+std::vector<ThreadPool::WorkerStats> ThreadPool::get_stats() const {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats_start).count();
+
+    std::vector<WorkerStats> stats;
+    stats.reserve(workers.size());
+
+    for(const std::unique_ptr<Worker>& worker : workers) {
+        double busy_time = worker->busy_nanoseconds * 1e-9;
+        stats.emplace_back(worker->tasks_executed, worker->tasks_stolen, busy_time,
+                           elapsed > 0.0 ? busy_time / elapsed : 0.0);
+    }
+
+    return stats;
+}
+
+void ThreadPool::reset_stats() {
+    for(std::unique_ptr<Worker>& worker : workers) {
+        worker->tasks_executed = 0;
+        worker->tasks_stolen = 0;
+        worker->busy_nanoseconds = 0;
+    }
+
+    stats_start = std::chrono::steady_clock::now();
+}
+
+ThreadPool::TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool), pending(0) { }
+
+ThreadPool::TaskGroup::~TaskGroup() {
+    wait_for_tasks();
+}
+
+void ThreadPool::TaskGroup::submit(std::function<void()> task) {
+    ++pending;
+
+    /* The group catches the exceptions of its tasks so that they do not reach the pool */
+    pool.submit([this, task = std::move(task)] {
+        try {
+            task();
+        } catch(...) {
+            std::lock_guard lock(mutex);
+            if(!exception) { exception = std::current_exception(); }
+        }
+
+        /* Under the lock, so that the group cannot be destroyed before the task is done with it */
+        std::lock_guard lock(mutex);
+        if(--pending == 0) { done_condition.notify_all(); }
+    });
+}
+
+void ThreadPool::TaskGroup::wait() {
+    wait_for_tasks();
+
+    std::lock_guard lock(mutex);
+    if(exception) {
+        std::exception_ptr thrown = std::exchange(exception, nullptr);
+        std::rethrow_exception(thrown);
+    }
+}
+
+void ThreadPool::TaskGroup::wait_for_tasks() {
+    /* A worker must keep running tasks, as the ones of the group may be queued behind it */
+    if(current_pool == &pool) {
+        while(pending > 0) {
+            if(!pool.try_run_task(current_worker)) { std::this_thread::yield(); }
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    done_condition.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::worker_loop(unsigned int index) {
+    current_pool = this;
+    current_worker = index;
+
+    while(true) {
+        if(try_run_task(index)) { continue; }
+
+        std::unique_lock lock(mutex);
+        wake_condition.wait(lock, [this] { return stopping || queued > 0; });
+        if(stopping && queued == 0) { return; }
+    }
+}
+
+bool ThreadPool::try_run_task(unsigned int index) {
+    std::function<void()> task;
+    bool stolen = false;
+
+    /* Own deque, newest task first */
+    {
+        Worker& worker = *workers[index];
+        std::lock_guard lock(worker.mutex);
+        if(!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+    }
+
+    /* Steal the oldest task of another worker */
+    for(std::size_t i = 1 ; !task && i < workers.size() ; ++i) {
+        Worker& victim = *workers[(index + i) % workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen = true;
+        }
+    }
+
+    if(!task) { return false; }
+    --queued;
+
+    /* Execute. Tasks run by a task waiting on a group are already part of its busy time */
+    auto start = std::chrono::steady_clock::now();
+    ++task_depth;
+
+    try {
+        task();
+    } catch(...) {
+        std::lock_guard lock(mutex);
+        if(!exception) { exception = std::current_exception(); }
+    }
+
+    Worker& worker = *workers[index];
+    if(--task_depth == 0) {
+        worker.busy_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+    }
+    ++worker.tasks_executed;
+    if(stolen) { ++worker.tasks_stolen; }
+
+    if(--pending == 0) {
+        std::lock_guard lock(mutex);
+        done_condition.notify_all();
+    }
+
+    return true;
+}
@@ -0,0 +1,867 @@
+/***************************************************************************************************
+ * @file  BVH.cpp
+ * @brief Implementation of the BVH class
+ **************************************************************************************************/
+
+#include "acceleration/BVH.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+
+#include "cache/CacheReader.hpp"
+#include "cache/CacheWriter.hpp"
+
+namespace {
+    /**
+     * @brief Gives a component of a vec3.
+     * @param vec The vec3.
+     * @param axis 0 for x, 1 for y and 2 for z.
+     * @return The component.
+     */
+    float get_axis(const vec3& vec, unsigned int axis) {
+        return axis == 0 ? vec.x : axis == 1 ? vec.y : vec.z;
+    }
+
+    /**
+     * @brief Makes an SAH cost relative to the surface area of the root. The nodes of a root without
+     * area, around points or primitives along a line, have no area either, so their cost is kept
+     * as is, 0, rather than becoming 0 / 0.
+     * @param cost The cost, not relative to the surface area of the root.
+     * @param root_area The surface area of the root.
+     * @return The relative cost.
+     */
+    float get_relative_cost(float cost, float root_area) {
+        return root_area > 0.0f ? cost / root_area : cost;
+    }
+
+    /**
+     * @struct BuildPrimitive
+     * @brief A primitive being sorted into the hierarchy. The build moves these records rather than
+     * indices so that every pass over a node reads memory sequentially. Centroids are recomputed
+     * from the bounds, which is cheaper than moving them around.
+     */
+    struct BuildPrimitive {
+        AABB bounds;
+        std::uint32_t index;
+    };
+
+    /**
+     * @struct Bin
+     * @brief The primitives whose centroid falls in a slice of a node along an axis.
+     */
+    struct Bin {
+        AABB bounds;
+        AABB centroid_bounds;
+        std::uint32_t count = 0;
+    };
+
+    /**
+     * @struct Bins
+     * @brief The bins of the three axes.
+     */
+    struct Bins {
+        Bin bins[3][BVH::bin_count];
+    };
+
+    /**
+     * @struct Split
+     * @brief The best split plane found for a node.
+     */
+    struct Split {
+        unsigned int axis = 0;
+        unsigned int bin = 0; ///< Centroids in bins below this one go to the left child.
+        float cost = std::numeric_limits<float>::infinity();
+    };
+
+    constexpr std::uint32_t parallel_node_threshold = 1 << 12;  ///< Smaller nodes build their children in the same task.
+    constexpr std::uint32_t parallel_split_threshold = 1 << 16; ///< Bigger nodes are binned and partitioned by several tasks.
+    constexpr std::uint32_t min_chunk_size = 1 << 14;           ///< The minimum number of primitives of such a task.
+    constexpr std::uint32_t max_30_bit_morton_count = 1 << 16;  ///< Bigger sets are sorted along 63-bit Morton codes.
+
+    /**
+     * @brief Gives the number of bits per axis of a Morton code.
+     * @tparam MortonCode std::uint32_t for 30-bit codes, std::uint64_t for 63-bit codes.
+     */
+    template<typename MortonCode>
+    constexpr unsigned int morton_axis_bits = sizeof(MortonCode) == 4 ? 10 : 21;
+
+    /**
+     * @brief Gives the bin of a centroid.
+     * @param centroid The centroid along the binning axis.
+     * @param min The minimum of the centroids along the binning axis.
+     * @param scale The number of bins divided by the extent of the centroids along the axis.
+     * @param bin_count The number of bins.
+     * @return The index of the bin.
+     */
+    unsigned int get_bin(float centroid, float min, float scale, unsigned int bin_count) {
+        return std::min(static_cast<unsigned int>((centroid - min) * scale), bin_count - 1);
+    }
+
+    /**
+     * @brief Gives the number of chunks a range of primitives is split into to be processed in parallel.
+     * @param pool The pool, nullptr for a serial build.
+     * @param count The number of primitives.
+     * @return The number of chunks, 1 if the range is processed by the calling thread.
+     */
+    unsigned int get_chunk_count(ThreadPool* pool, std::uint32_t count) {
+        if(pool == nullptr || pool->size() == 1 || count < parallel_split_threshold) { return 1; }
+
+        return std::clamp(count / min_chunk_size, 1u, 4 * pool->size());
+    }
+
+    /**
+     * @brief Calls a function on every chunk of a range of primitives, in parallel if there are
+     * several chunks.
+     * @param pool The pool, nullptr for a serial build.
+     * @param first The first primitive of the range.
+     * @param count The number of primitives of the range.
+     * @param chunk_count The number of chunks.
+     * @param function Called as function(chunk, begin, end) on the chunks.
+     */
+    template<typename Function>
+    void for_each_chunk(ThreadPool* pool, std::uint32_t first, std::uint32_t count, unsigned int chunk_count,
+                        const Function& function) {
+        if(chunk_count == 1) { return function(0, first, first + count); }
+
+        ThreadPool::TaskGroup group(*pool);
+        for(unsigned int chunk = 0 ; chunk < chunk_count ; ++chunk) {
+            std::uint32_t begin = first + static_cast<std::uint64_t>(count) * chunk / chunk_count;
+            std::uint32_t end = first + static_cast<std::uint64_t>(count) * (chunk + 1) / chunk_count;
+            group.submit([&function, chunk, begin, end] { function(chunk, begin, end); });
+        }
+        group.wait();
+    }
+
+    /**
+     * @brief Inserts two zeros before each of the 10 lowest bits of an integer.
+     * @param bits The integer.
+     * @return The spread bits.
+     */
+    std::uint32_t spread_bits(std::uint32_t bits) {
+        bits = (bits | bits << 16) & 0x030000FFu;
+        bits = (bits | bits << 8) & 0x0300F00Fu;
+        bits = (bits | bits << 4) & 0x030C30C3u;
+        bits = (bits | bits << 2) & 0x09249249u;
+
+        return bits;
+    }
+
+    /**
+     * @brief Inserts two zeros before each of the 21 lowest bits of an integer.
+     * @param bits The integer.
+     * @return The spread bits.
+     */
+    std::uint64_t spread_bits(std::uint64_t bits) {
+        bits = (bits | bits << 32) & 0x001F00000000FFFFull;
+        bits = (bits | bits << 16) & 0x001F0000FF0000FFull;
+        bits = (bits | bits << 8) & 0x100F00F00F00F00Full;
+        bits = (bits | bits << 4) & 0x10C30C30C30C30C3ull;
+        bits = (bits | bits << 2) & 0x1249249249249249ull;
+
+        return bits;
+    }
+
+    /**
+     * @brief Calculates the Morton code of a point by interleaving the bits of its quantized
+     * coordinates, x having the highest bit.
+     * @tparam MortonCode std::uint32_t for 30-bit codes, std::uint64_t for 63-bit codes.
+     * @param point The point relative to the smallest corner of the quantized bounds.
+     * @param scales The number of cells per axis divided by the extent of the bounds along it.
+     * @return The Morton code.
+     */
+    template<typename MortonCode>
+    MortonCode get_morton_code(const vec3& point, const float scales[3]) {
+        constexpr MortonCode max_cell = (MortonCode(1) << morton_axis_bits<MortonCode>) - 1;
+        MortonCode code = 0;
+
+        for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+            float cell = std::max(get_axis(point, axis) * scales[axis], 0.0f);
+            code |= spread_bits(std::min(static_cast<MortonCode>(cell), max_cell)) << (2 - axis);
+        }
+
+        return code;
+    }
+
+    /**
+     * @brief Sorts primitives by Morton code with a least significant digit radix sort, 8 bits per
+     * pass. Every chunk counts its digits, then scatters its primitives after the smaller digits and
+     * after the same digit of the previous chunks, so each pass is stable. Passes where every code
+     * has the same digit are skipped.
+     * @tparam MortonCode std::uint32_t for 30-bit codes, std::uint64_t for 63-bit codes.
+     * @param pool The pool, nullptr for a serial sort.
+     * @param codes The codes, sorted on return.
+     * @param indices The primitive of every code, moved along with the codes.
+     */
+    template<typename MortonCode>
+    void radix_sort(ThreadPool* pool, std::vector<MortonCode>& codes, std::vector<std::uint32_t>& indices) {
+        constexpr unsigned int digit_count = 256;
+
+        const std::uint32_t count = codes.size();
+        const unsigned int chunk_count = get_chunk_count(pool, count);
+        std::vector<std::array<std::uint32_t, digit_count>> offsets(chunk_count);
+        std::vector<MortonCode> sorted_codes(count);
+        std::vector<std::uint32_t> sorted_indices(count);
+
+        for(unsigned int shift = 0 ; shift < 3 * morton_axis_bits<MortonCode> ; shift += 8) {
+            for_each_chunk(pool, 0, count, chunk_count, [&](unsigned int chunk, std::uint32_t begin, std::uint32_t end) {
+                offsets[chunk].fill(0);
+                for(std::uint32_t i = begin ; i < end ; ++i) { ++offsets[chunk][codes[i] >> shift & (digit_count - 1)]; }
+            });
+
+            std::uint32_t offset = 0;
+            bool single_digit = false;
+            for(unsigned int digit = 0 ; digit < digit_count ; ++digit) {
+                std::uint32_t digit_total = 0;
+                for(std::array<std::uint32_t, digit_count>& chunk_offsets : offsets) {
+                    std::uint32_t digit_chunk_count = chunk_offsets[digit];
+                    chunk_offsets[digit] = offset;
+                    offset += digit_chunk_count;
+                    digit_total += digit_chunk_count;
+                }
+                single_digit |= digit_total == count;
+            }
+
+            if(single_digit) { continue; }
+
+            for_each_chunk(pool, 0, count, chunk_count, [&](unsigned int chunk, std::uint32_t begin, std::uint32_t end) {
+                for(std::uint32_t i = begin ; i < end ; ++i) {
+                    std::uint32_t& destination = offsets[chunk][codes[i] >> shift & (digit_count - 1)];
+                    sorted_codes[destination] = codes[i];
+                    sorted_indices[destination] = indices[i];
+                    ++destination;
+                }
+            });
+
+            codes.swap(sorted_codes);
+            indices.swap(sorted_indices);
+        }
+    }
+
+    /**
+     * @brief Finds where a range of sorted Morton codes splits: after the last code having the same
+     * bit as the first one at the highest bit where the first and the last codes differ. A range of
+     * identical codes is split in the middle.
+     * @tparam MortonCode std::uint32_t for 30-bit codes, std::uint64_t for 63-bit codes.
+     * @param codes The sorted codes.
+     * @param first The index of the first code of the range.
+     * @param last The index of the last code of the range.
+     * @return The index of the last code of the first half.
+     */
+    template<typename MortonCode>
+    std::uint32_t find_split(std::span<const MortonCode> codes, std::uint32_t first, std::uint32_t last) {
+        if(codes[first] == codes[last]) { return first + (last - first) / 2; }
+
+        /* Binary search of the last code sharing more leading bits with the first one than the last one does */
+        const int common_prefix = std::countl_zero(codes[first] ^ codes[last]);
+        std::uint32_t split = first;
+        std::uint32_t step = last - first;
+
+        do {
+            step = (step + 1) / 2;
+            std::uint32_t candidate = split + step;
+            if(candidate < last && std::countl_zero(codes[first] ^ codes[candidate]) > common_prefix) { split = candidate; }
+        } while(step > 1);
+
+        return split;
+    }
+}
+
+static_assert(sizeof(BVH::Node) == 32, "BVH nodes must be half a cache line");
+
+/**
+ * @struct BVH::BuildNode
+ * @brief A node of the binary tree the build produces before it is flattened.
+ */
+struct BVH::BuildNode {
+    AABB bounds;                  ///< The bounds of everything below the node.
+    std::uint32_t left = 0;       ///< The index of the left child of an inner node.
+    std::uint32_t right = 0;      ///< The index of the right child of an inner node.
+    std::uint32_t first = 0;      ///< The index of the first primitive of a leaf.
+    std::uint32_t count = 0;      ///< The number of primitives of a leaf, 0 for an inner node.
+    unsigned int axis = 0;        ///< The axis an inner node is split along.
+    std::uint32_t slot_count = 0; ///< The number of slots of the flattened subtree.
+};
+
+/**
+ * @struct BVH::BuildContext
+ * @brief The state shared by the tasks building a BVH.
+ */
+struct BVH::BuildContext {
+    std::vector<BuildNode> nodes;           ///< The nodes of the binary tree, the root being the first one.
+    std::vector<BuildPrimitive> primitives; ///< The primitives, partitioned as the nodes are split.
+    std::vector<BuildPrimitive> scratch;    ///< Where the parallel partitions scatter the primitives of a node, at the same offsets.
+    std::atomic<std::uint32_t> node_count;  ///< The number of nodes allocated so far.
+    ThreadPool* pool;                       ///< The pool running the build, nullptr for a serial build.
+
+    /**
+     * @brief Calculates the bounds of a range of primitives and of their centroids.
+     * @param first The first primitive of the range.
+     * @param count The number of primitives of the range.
+     * @param bounds The bounds of the primitives.
+     * @param centroid_bounds The bounds of their centroids.
+     */
+    void compute_bounds(std::uint32_t first, std::uint32_t count, AABB& bounds, AABB& centroid_bounds) const {
+        unsigned int chunk_count = get_chunk_count(pool, count);
+        std::vector<AABB> chunk_bounds(2 * chunk_count);
+
+        for_each_chunk(pool, first, count, chunk_count, [&](unsigned int chunk, std::uint32_t begin, std::uint32_t end) {
+            for(std::uint32_t i = begin ; i < end ; ++i) {
+                chunk_bounds[2 * chunk].grow(primitives[i].bounds);
+                chunk_bounds[2 * chunk + 1].grow(primitives[i].bounds.get_center());
+            }
+        });
+
+        bounds = AABB();
+        centroid_bounds = AABB();
+        for(unsigned int chunk = 0 ; chunk < chunk_count ; ++chunk) {
+            bounds.grow(chunk_bounds[2 * chunk]);
+            centroid_bounds.grow(chunk_bounds[2 * chunk + 1]);
+        }
+    }
+};
+
+BVH::BVH(std::span<const AABB> primitive_bounds, Builder builder)
+    : builder(builder) {
+    build(primitive_bounds, nullptr);
+}
+
+BVH::BVH(std::span<const AABB> primitive_bounds, ThreadPool& pool, Builder builder)
+    : builder(builder) {
+    build(primitive_bounds, &pool);
+}
+
+BVH::BVH(CacheReader& reader, std::uint32_t primitive_count) {
+    reader.read_array(nodes);
+    builder = reader.read_value<Builder>();
+    this->primitive_count = reader.read_value<std::uint32_t>();
+    built_sah_cost = reader.read_value<float>();
+
+    if(this->primitive_count != primitive_count) {
+        throw std::runtime_error("Failed to read a cached hierarchy, it was built for other primitives");
+    }
+
+    validate();
+}
+
+void BVH::save(CacheWriter& writer) const {
+    writer.write_array(std::span<const Node>(nodes));
+    writer.write_value(builder);
+    writer.write_value(primitive_count);
+    writer.write_value(built_sah_cost);
+}
+
+bool BVH::refit(std::span<const AABB> primitive_bounds) {
+    return update(primitive_bounds, nullptr);
+}
+
+bool BVH::refit(std::span<const AABB> primitive_bounds, ThreadPool& pool) {
+    return update(primitive_bounds, &pool);
+}
+
+AABB BVH::get_bounds() const {
+    if(nodes.empty()) { return AABB(); }
+
+    return AABB(vec3(nodes[0].min[0], nodes[0].min[1], nodes[0].min[2]),
+                vec3(nodes[0].max[0], nodes[0].max[1], nodes[0].max[2]));
+}
+
+const std::vector<BVH::Node>& BVH::get_nodes() const {
+    return nodes;
+}
+
+std::uint32_t BVH::get_primitive(std::uint32_t leaf, std::uint32_t primitive) const {
+    return primitive == 0 ? nodes[leaf].offset : get_other_primitives(leaf)[primitive - 1];
+}
+
+float BVH::get_sah_cost() const {
+    if(nodes.empty()) { return 0.0f; }
+
+    float cost = 0.0f;
+    for(std::size_t index = 0 ; index < nodes.size() ; ) {
+        const Node& node = nodes[index];
+        index += 1 + (node.is_leaf() ? Node::get_index_slot_count(node.count) : 0);
+
+        cost += get_node_cost(node);
+    }
+
+    return get_relative_cost(cost, get_bounds().get_surface_area());
+}
+
+void BVH::build(std::span<const AABB> primitive_bounds, ThreadPool* pool) {
+    std::uint32_t count = primitive_bounds.size();
+    primitive_count = count;
+    if(count == 0) { return; }
+
+    /* The Morton build gathers the sorted primitives into the scratch array */
+    const unsigned int chunk_count = get_chunk_count(pool, count);
+    BuildContext context{
+        std::vector<BuildNode>(2 * count - 1), std::vector<BuildPrimitive>(count),
+        std::vector<BuildPrimitive>(chunk_count > 1 || builder == Builder::Morton ? count : 0), 1, pool
+    };
+
+    for_each_chunk(pool, 0, count, chunk_count, [&](unsigned int, std::uint32_t begin, std::uint32_t end) {
+        for(std::uint32_t primitive = begin ; primitive < end ; ++primitive) {
+            context.primitives[primitive] = { primitive_bounds[primitive], primitive };
+        }
+    });
+
+    AABB bounds;
+    AABB centroid_bounds;
+    context.compute_bounds(0, count, bounds, centroid_bounds);
+
+    /* Nodes are allocated by pairs of siblings from a shared counter, so that tasks can build
+     * subtrees concurrently; a binary tree with one primitive per leaf has 2 * count - 1 nodes.
+     * 1024 cells per axis are enough to tell apart the centroids of small sets, whose 30-bit codes
+     * are sorted in half the passes */
+    if(builder == Builder::SAH) {
+        build_node(context, 0, 0, count, 0, bounds, centroid_bounds);
+    } else if(count <= max_30_bit_morton_count) {
+        build_morton<std::uint32_t>(context, centroid_bounds);
+    } else {
+        build_morton<std::uint64_t>(context, centroid_bounds);
+    }
+
+    nodes.resize(context.nodes[0].slot_count);
+    flatten(context, 0, 0);
+
+    built_sah_cost = get_sah_cost();
+}
+
+void BVH::build_node(BuildContext& context, std::uint32_t node, std::uint32_t first, std::uint32_t count,
+                     unsigned int depth, const AABB& bounds, const AABB& centroid_bounds) {
+    BuildNode& current = context.nodes[node];
+    current.bounds = bounds;
+
+    auto make_leaf = [&] {
+        current.first = first;
+        current.count = count;
+        current.slot_count = 1 + Node::get_index_slot_count(count);
+    };
+
+    if(count == 1) { return make_leaf(); }
+
+    /* Bin the centroids along every axis, each chunk into its own bins, then sweep the merged bins
+     * from both ends to evaluate the split planes of each axis. Small nodes use as many bins as they
+     * have primitives, as setting up and sweeping all the bins dominates their cost */
+    const unsigned int node_bin_count = std::min(bin_count, count);
+    const vec3 extent = centroid_bounds.get_extent();
+    float mins[3];
+    float scales[3];
+    for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+        mins[axis] = get_axis(centroid_bounds.min, axis);
+        scales[axis] = get_axis(extent, axis) > 0.0f ? node_bin_count / get_axis(extent, axis) : 0.0f;
+    }
+
+    auto bin_primitives = [&](std::uint32_t begin, std::uint32_t end, Bins& bins) {
+        for(std::uint32_t i = begin ; i < end ; ++i) {
+            const BuildPrimitive& primitive = context.primitives[i];
+            const vec3 centroid = primitive.bounds.get_center();
+
+            for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+                Bin& bin = bins.bins[axis][get_bin(get_axis(centroid, axis), mins[axis], scales[axis], node_bin_count)];
+                bin.bounds.grow(primitive.bounds);
+                bin.centroid_bounds.grow(centroid);
+                ++bin.count;
+            }
+        }
+    };
+
+    const unsigned int chunk_count = get_chunk_count(context.pool, count);
+    Bins bins;
+
+    if(chunk_count == 1) {
+        bin_primitives(first, first + count, bins);
+    } else {
+        std::vector<Bins> chunk_bins(chunk_count);
+        for_each_chunk(context.pool, first, count, chunk_count, [&](unsigned int chunk, std::uint32_t begin, std::uint32_t end) {
+            bin_primitives(begin, end, chunk_bins[chunk]);
+        });
+
+        for(const Bins& chunk : chunk_bins) {
+            for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+                for(unsigned int bin = 0 ; bin < node_bin_count ; ++bin) {
+                    bins.bins[axis][bin].bounds.grow(chunk.bins[axis][bin].bounds);
+                    bins.bins[axis][bin].centroid_bounds.grow(chunk.bins[axis][bin].centroid_bounds);
+                    bins.bins[axis][bin].count += chunk.bins[axis][bin].count;
+                }
+            }
+        }
+    }
+
+    Split split;
+    for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+        if(scales[axis] == 0.0f) { continue; }
+
+        const Bin* axis_bins = bins.bins[axis];
+        float right_costs[bin_count];
+        AABB right_bounds;
+        std::uint32_t right_count = 0;
+        for(unsigned int bin = node_bin_count - 1 ; bin > 0 ; --bin) {
+            right_bounds.grow(axis_bins[bin].bounds);
+            right_count += axis_bins[bin].count;
+            right_costs[bin] = right_count * right_bounds.get_surface_area();
+        }
+
+        AABB left_bounds;
+        std::uint32_t left_count = 0;
+        for(unsigned int bin = 1 ; bin < node_bin_count ; ++bin) {
+            left_bounds.grow(axis_bins[bin - 1].bounds);
+            left_count += axis_bins[bin - 1].count;
+            if(left_count == 0 || left_count == count) { continue; }
+
+            float cost = left_count * left_bounds.get_surface_area() + right_costs[bin];
+            if(cost < split.cost) { split = { axis, bin, cost }; }
+        }
+    }
+
+    float area = bounds.get_surface_area();
+    float leaf_cost = intersection_cost * count * area;
+    float split_cost = traversal_cost * area + intersection_cost * split.cost;
+
+    if(count <= max_leaf_size && !(split_cost < leaf_cost)) { return make_leaf(); }
+
+    /* Partition the primitives around the split plane. Past half the stack depth, or when no plane
+     * separates the centroids, fall back to a median split along the widest axis: it halves the
+     * count, so the 32-bit primitive counts always fit in the remaining depth */
+    BuildPrimitive* begin = context.primitives.data() + first;
+    BuildPrimitive* end = begin + count;
+    BuildPrimitive* middle = end;
+
+    if(split.cost != std::numeric_limits<float>::infinity() && depth < max_depth / 2 - 1) {
+        current.axis = split.axis;
+
+        auto is_left = [&, min = mins[split.axis], scale = scales[split.axis]](const BuildPrimitive& primitive) {
+            return get_bin(get_axis(primitive.bounds.get_center(), split.axis), min, scale, node_bin_count) < split.bin;
+        };
+
+        if(chunk_count == 1) {
+            middle = std::partition(begin, end, is_left);
+        } else {
+            /* Scatter every chunk at its offsets on both sides */
+            std::vector<std::uint32_t> left_counts(chunk_count, 0);
+            for_each_chunk(context.pool, first, count, chunk_count, [&](unsigned int chunk, std::uint32_t chunk_begin, std::uint32_t chunk_end) {
+                for(std::uint32_t i = chunk_begin ; i < chunk_end ; ++i) { left_counts[chunk] += is_left(context.primitives[i]); }
+            });
+
+            std::uint32_t left_total = std::accumulate(left_counts.begin(), left_counts.end(), 0u);
+            BuildPrimitive* partitioned = context.scratch.data() + first;
+
+            for_each_chunk(context.pool, first, count, chunk_count, [&](unsigned int chunk, std::uint32_t chunk_begin, std::uint32_t chunk_end) {
+                std::uint32_t left_offset = std::accumulate(left_counts.begin(), left_counts.begin() + chunk, 0u);
+                std::uint32_t right_offset = left_total + (chunk_begin - first) - left_offset;
+
+                for(std::uint32_t i = chunk_begin ; i < chunk_end ; ++i) {
+                    const BuildPrimitive& primitive = context.primitives[i];
+                    partitioned[is_left(primitive) ? left_offset++ : right_offset++] = primitive;
+                }
+            });
+
+            for_each_chunk(context.pool, first, count, chunk_count, [&](unsigned int, std::uint32_t chunk_begin, std::uint32_t chunk_end) {
+                std::copy(partitioned + (chunk_begin - first), partitioned + (chunk_end - first),
+                          context.primitives.begin() + chunk_begin);
+            });
+
+            middle = begin + left_total;
+        }
+    }
+
+    /* The bins of the split axis give the bounds of both children */
+    AABB left_bounds;
+    AABB left_centroid_bounds;
+    AABB right_bounds;
+    AABB right_centroid_bounds;
+
+    if(middle != begin && middle != end) {
+        for(unsigned int bin = 0 ; bin < node_bin_count ; ++bin) {
+            const Bin& split_bin = bins.bins[split.axis][bin];
+            (bin < split.bin ? left_bounds : right_bounds).grow(split_bin.bounds);
+            (bin < split.bin ? left_centroid_bounds : right_centroid_bounds).grow(split_bin.centroid_bounds);
+        }
+    } else {
+        unsigned int axis = extent.x > extent.y && extent.x > extent.z ? 0 : extent.y > extent.z ? 1 : 2;
+        current.axis = axis;
+        middle = begin + count / 2;
+
+        std::nth_element(begin, middle, end, [axis](const BuildPrimitive& left, const BuildPrimitive& right) {
+            return get_axis(left.bounds.get_center(), axis) < get_axis(right.bounds.get_center(), axis);
+        });
+
+        context.compute_bounds(first, middle - begin, left_bounds, left_centroid_bounds);
+        context.compute_bounds(first + (middle - begin), end - middle, right_bounds, right_centroid_bounds);
+    }
+
+    std::uint32_t left_count = middle - begin;
+    std::uint32_t left = context.node_count.fetch_add(2, std::memory_order_relaxed);
+    current.left = left;
+    current.right = left + 1;
+
+    /* Big subtrees are built by another task while this one builds the right child */
+    auto build_left = [&] {
+        build_node(context, left, first, left_count, depth + 1, left_bounds, left_centroid_bounds);
+    };
+    auto build_right = [&] {
+        build_node(context, left + 1, first + left_count, count - left_count, depth + 1, right_bounds, right_centroid_bounds);
+    };
+
+    if(context.pool != nullptr && count >= parallel_node_threshold) {
+        ThreadPool::TaskGroup group(*context.pool);
+        group.submit(build_left);
+        build_right();
+        group.wait();
+    } else {
+        build_left();
+        build_right();
+    }
+
+    current.slot_count = 1 + context.nodes[left].slot_count + context.nodes[left + 1].slot_count;
+}
+
+template<typename MortonCode>
+void BVH::build_morton(BuildContext& context, const AABB& centroid_bounds) {
+    const std::uint32_t count = context.primitives.size();
+    const unsigned int chunk_count = get_chunk_count(context.pool, count);
+
+    const vec3 extent = centroid_bounds.get_extent();
+    float scales[3];
+    for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+        constexpr float cell_count = MortonCode(1) << morton_axis_bits<MortonCode>;
+        scales[axis] = get_axis(extent, axis) > 0.0f ? cell_count / get_axis(extent, axis) : 0.0f;
+    }
+
+    std::vector<MortonCode> codes(count);
+    std::vector<std::uint32_t> order(count);
+    for_each_chunk(context.pool, 0, count, chunk_count, [&](unsigned int, std::uint32_t begin, std::uint32_t end) {
+        for(std::uint32_t i = begin ; i < end ; ++i) {
+            codes[i] = get_morton_code<MortonCode>(context.primitives[i].bounds.get_center() - centroid_bounds.min, scales);
+            order[i] = i;
+        }
+    });
+
+    radix_sort(context.pool, codes, order);
+
+    /* Every node covers a contiguous range of the primitives in the order of their codes */
+    for_each_chunk(context.pool, 0, count, chunk_count, [&](unsigned int, std::uint32_t begin, std::uint32_t end) {
+        for(std::uint32_t i = begin ; i < end ; ++i) { context.scratch[i] = context.primitives[order[i]]; }
+    });
+    context.primitives.swap(context.scratch);
+
+    build_morton_node<MortonCode>(context, codes, 0, 0, count - 1, 0);
+}
+
+template<typename MortonCode>
+float BVH::build_morton_node(BuildContext& context, std::span<const MortonCode> codes, std::uint32_t node,
+                             std::uint32_t first, std::uint32_t last, unsigned int depth) {
+    BuildNode& current = context.nodes[node];
+    const std::uint32_t count = last - first + 1;
+
+    auto make_leaf = [&] {
+        current.first = first;
+        current.count = count;
+        current.slot_count = 1 + Node::get_index_slot_count(count);
+
+        return intersection_cost * count * current.bounds.get_surface_area();
+    };
+
+    /* Past the depth of the traversal stack, the rest of the range becomes a single leaf */
+    if(count == 1 || depth == max_depth - 1) {
+        for(std::uint32_t i = first ; i <= last ; ++i) { current.bounds.grow(context.primitives[i].bounds); }
+        return make_leaf();
+    }
+
+    /* As in Karras' layout, an inner child has the index of the code its range ends or starts at and
+     * the leaves follow the count - 1 inner nodes, so that tasks never allocate the same node */
+    const std::uint32_t split = find_split(codes, first, last);
+    const std::uint32_t left = split == first ? codes.size() - 1 + split : split;
+    const std::uint32_t right = split + 1 == last ? codes.size() + split : split + 1;
+    current.left = left;
+    current.right = right;
+
+    /* The children are on both sides of the highest bit where the codes of the range differ */
+    const MortonCode difference = codes[first] ^ codes[last];
+    current.axis = difference == 0 ? 0 : 2 - (std::bit_width(difference) - 1) % 3;
+
+    /* Big subtrees are built by another task while this one builds the right child */
+    float left_cost = 0.0f;
+    float right_cost = 0.0f;
+    auto build_left = [&] { left_cost = build_morton_node(context, codes, left, first, split, depth + 1); };
+    auto build_right = [&] { right_cost = build_morton_node(context, codes, right, split + 1, last, depth + 1); };
+
+    if(context.pool != nullptr && count >= parallel_node_threshold) {
+        ThreadPool::TaskGroup group(*context.pool);
+        group.submit(build_left);
+        build_right();
+        group.wait();
+    } else {
+        build_left();
+        build_right();
+    }
+
+    current.bounds = context.nodes[left].bounds;
+    current.bounds.grow(context.nodes[right].bounds);
+
+    /* Small subtrees cheaper to test as a whole are collapsed into a leaf */
+    float area = current.bounds.get_surface_area();
+    float cost = traversal_cost * area + left_cost + right_cost;
+    if(count <= max_leaf_size && !(cost < intersection_cost * count * area)) { return make_leaf(); }
+
+    current.slot_count = 1 + context.nodes[left].slot_count + context.nodes[right].slot_count;
+    return cost;
+}
+
+void BVH::validate() const {
+    if(nodes.empty() != (primitive_count == 0)) {
+        throw std::runtime_error("Failed to read a cached hierarchy, it does not match its primitive count");
+    }
+    if(nodes.empty()) { return; }
+
+    /* Walking the hierarchy depth-first must visit every slot exactly once and in order, which also
+     * rules out cycles and children outside of the array */
+    std::vector<std::pair<std::uint32_t, unsigned int>> stack = { { 0, 0 } };
+    std::uint32_t cursor = 0;
+    std::uint64_t leaf_primitive_count = 0;
+
+    while(!stack.empty()) {
+        auto [index, depth] = stack.back();
+        stack.pop_back();
+
+        if(index != cursor || index >= nodes.size() || depth >= max_depth) {
+            throw std::runtime_error("Failed to read a cached hierarchy, its nodes are not laid out depth-first");
+        }
+
+        const Node& node = nodes[index];
+        if(node.is_leaf()) {
+            std::uint32_t slot_count = Node::get_index_slot_count(node.count);
+            if(node.count == 0 || slot_count > nodes.size() - index - 1) {
+                throw std::runtime_error("Failed to read a cached hierarchy, a leaf overflows the node array");
+            }
+
+            for(std::uint32_t primitive = 0 ; primitive < node.count ; ++primitive) {
+                if(get_primitive(index, primitive) >= primitive_count) {
+                    throw std::runtime_error("Failed to read a cached hierarchy, a leaf refers to a missing primitive");
+                }
+            }
+
+            leaf_primitive_count += node.count;
+            cursor = index + 1 + slot_count;
+        } else {
+            if((node.count & ~Node::inner_flag) > 2) {
+                throw std::runtime_error("Failed to read a cached hierarchy, a node has no split axis");
+            }
+
+            stack.push_back({ node.offset, depth + 1 });
+            stack.push_back({ index + 1, depth + 1 });
+            cursor = index + 1;
+        }
+    }
+
+    if(cursor != nodes.size() || leaf_primitive_count != primitive_count) {
+        throw std::runtime_error("Failed to read a cached hierarchy, it does not match its primitive count");
+    }
+}
+
+bool BVH::update(std::span<const AABB> primitive_bounds, ThreadPool* pool) {
+    /* The topology only fits the primitives it was built for */
+    if(nodes.empty() || primitive_count != primitive_bounds.size()) {
+        nodes.clear();
+        build(primitive_bounds, pool);
+        return true;
+    }
+
+    /* A hierarchy built without area costs 0, so it is rebuilt as soon as its primitives spread */
+    float cost = get_relative_cost(refit_node(primitive_bounds, pool, 0, nodes.size()), get_bounds().get_surface_area());
+    if(!(cost > rebuild_threshold * built_sah_cost)) { return false; }
+
+    nodes.clear();
+    build(primitive_bounds, pool);
+    return true;
+}
+
+float BVH::refit_node(std::span<const AABB> primitive_bounds, ThreadPool* pool, std::uint32_t node, std::uint32_t end) {
+    Node& current = nodes[node];
+    AABB bounds;
+    float cost = 0.0f;
+
+    if(current.is_leaf()) {
+        bounds.grow(primitive_bounds[current.offset]);
+
+        const std::uint32_t* primitives = get_other_primitives(node);
+        for(std::uint32_t i = 0 ; i + 1 < current.count ; ++i) { bounds.grow(primitive_bounds[primitives[i]]); }
+    } else {
+        /* The children are refitted first, big subtrees by another task while this one refits the
+         * second child */
+        float left_cost = 0.0f;
+        float right_cost = 0.0f;
+
+        if(pool != nullptr && end - node >= parallel_node_threshold) {
+            ThreadPool::TaskGroup group(*pool);
+            group.submit([&] { left_cost = refit_node(primitive_bounds, pool, node + 1, current.offset); });
+            right_cost = refit_node(primitive_bounds, pool, current.offset, end);
+            group.wait();
+        } else {
+            left_cost = refit_node(primitive_bounds, pool, node + 1, current.offset);
+            right_cost = refit_node(primitive_bounds, pool, current.offset, end);
+        }
+
+        for(std::uint32_t child : { node + 1, current.offset }) {
+            bounds.grow(vec3(nodes[child].min[0], nodes[child].min[1], nodes[child].min[2]));
+            bounds.grow(vec3(nodes[child].max[0], nodes[child].max[1], nodes[child].max[2]));
+        }
+
+        cost = left_cost + right_cost;
+    }
+
+    for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+        current.min[axis] = get_axis(bounds.min, axis);
+        current.max[axis] = get_axis(bounds.max, axis);
+    }
+
+    return cost + get_node_cost(current);
+}
+
+float BVH::get_node_cost(const Node& node) {
+    vec3 extent(node.max[0] - node.min[0], node.max[1] - node.min[1], node.max[2] - node.min[2]);
+    float area = 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+
+    return node.is_leaf() ? intersection_cost * node.count * area : traversal_cost * area;
+}
+
+void BVH::flatten(const BuildContext& context, std::uint32_t node, std::uint32_t slot) {
+    const BuildNode& current = context.nodes[node];
+    Node& flat = nodes[slot];
+
+    for(unsigned int axis = 0 ; axis < 3 ; ++axis) {
+        flat.min[axis] = get_axis(current.bounds.min, axis);
+        flat.max[axis] = get_axis(current.bounds.max, axis);
+    }
+
+    if(current.count > 0) {
+        flat.offset = context.primitives[current.first].index;
+        flat.count = current.count;
+
+        std::uint32_t* primitives = reinterpret_cast<std::uint32_t*>(nodes.data() + slot + 1);
+        for(std::uint32_t i = 1 ; i < current.count ; ++i) {
+            primitives[i - 1] = context.primitives[current.first + i].index;
+        }
+
+        return;
+    }
+
+    /* The first child follows its parent, the second one follows the whole subtree of the first */
+    const std::uint32_t right_slot = slot + 1 + context.nodes[current.left].slot_count;
+    flat.offset = right_slot;
+    flat.count = Node::inner_flag | current.axis;
+
+    if(context.pool != nullptr && current.slot_count >= parallel_node_threshold) {
+        ThreadPool::TaskGroup group(*context.pool);
+        group.submit([&] { flatten(context, current.left, slot + 1); });
+        flatten(context, current.right, right_slot);
+        group.wait();
+    } else {
+        flatten(context, current.left, slot + 1);
+        flatten(context, current.right, right_slot);
+    }
+}
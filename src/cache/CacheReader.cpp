@@ -0,0 +1,45 @@
+/***************************************************************************************************
+ * @file  CacheReader.cpp
+ * @brief Implementation of the CacheReader class
+ **************************************************************************************************/
+
+#include "cache/CacheReader.hpp"
+
+CacheReader::CacheReader(const std::string& path, std::uint64_t key)
+    : path(path), file(path), cursor(0) {
+    const std::span<const std::byte> bytes = file.get_bytes();
+
+    CacheHeader header;
+    if(bytes.size() < sizeof(CacheHeader)) { throw std::runtime_error("Failed to read truncated cache file '" + path + '\''); }
+    std::memcpy(&header, bytes.data(), sizeof(CacheHeader));
+
+    if(std::memcmp(header.magic, cache_magic, sizeof(header.magic)) != 0 || header.version != cache_version
+       || header.header_size != sizeof(CacheHeader)) {
+        throw std::runtime_error("Failed to read cache file '" + path + "', its version is not supported");
+    }
+    if(header.key != key) {
+        throw std::runtime_error("Failed to read cache file '" + path + "', it was built from other inputs");
+    }
+
+    /* The sections must be in the file, and the data section aligned like its arrays */
+    std::uint64_t table_end = sizeof(CacheHeader) + header.table_size;
+    if(header.table_size > bytes.size() || table_end > header.data_offset || header.data_offset % cache_alignment != 0
+       || header.data_offset > bytes.size() || header.data_size != bytes.size() - header.data_offset) {
+        throw std::runtime_error("Failed to read truncated cache file '" + path + '\'');
+    }
+
+    table = bytes.subspan(sizeof(CacheHeader), header.table_size);
+    data = bytes.subspan(header.data_offset, header.data_size);
+
+    if(hash_bytes(data, hash_bytes(table)) != header.checksum) {
+        throw std::runtime_error("Failed to read corrupted cache file '" + path + '\'');
+    }
+}
+
+const std::byte* CacheReader::consume(std::size_t size) {
+    if(size > table.size() - cursor) { throw std::runtime_error("Failed to read past the end of cache file '" + path + '\''); }
+
+    const std::byte* bytes = table.data() + cursor;
+    cursor += size;
+    return bytes;
+}
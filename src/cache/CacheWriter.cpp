@@ -0,0 +1,48 @@
+/***************************************************************************************************
+ * @file  CacheWriter.cpp
+ * @brief Implementation of the CacheWriter class
+ **************************************************************************************************/
+
+#include "cache/CacheWriter.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+void CacheWriter::save(const std::string& path, std::uint64_t key) const {
+    CacheHeader header{};
+    std::memcpy(header.magic, cache_magic, sizeof(header.magic));
+    header.version = cache_version;
+    header.header_size = sizeof(CacheHeader);
+    header.key = key;
+    header.checksum = hash_bytes(data, hash_bytes(table));
+    header.table_size = table.size();
+    header.data_offset = (sizeof(CacheHeader) + table.size() + cache_alignment - 1) / cache_alignment * cache_alignment;
+    header.data_size = data.size();
+
+    const std::string temporary_path = path + ".tmp";
+    std::FILE* file = std::fopen(temporary_path.c_str(), "wb");
+    if(file == nullptr) { throw std::runtime_error("Failed to create cache file '" + temporary_path + '\''); }
+
+    const std::byte padding[cache_alignment]{};
+    std::size_t padding_size = header.data_offset - sizeof(CacheHeader) - table.size();
+
+    bool is_written = std::fwrite(&header, sizeof(CacheHeader), 1, file) == 1
+                      && std::fwrite(table.data(), 1, table.size(), file) == table.size()
+                      && std::fwrite(padding, 1, padding_size, file) == padding_size
+                      && std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    is_written = std::fclose(file) == 0 && is_written;
+
+    if(!is_written) {
+        std::filesystem::remove(temporary_path);
+        throw std::runtime_error("Failed to write cache file '" + temporary_path + '\'');
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if(error) {
+        std::filesystem::remove(temporary_path, error);
+        throw std::runtime_error("Failed to rename cache file '" + temporary_path + '\'');
+    }
+}
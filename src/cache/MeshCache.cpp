@@ -0,0 +1,91 @@
+/***************************************************************************************************
+ * @file  MeshCache.cpp
+ * @brief Implementation of the MeshCache class
+ **************************************************************************************************/
+
+#include "cache/MeshCache.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "MappedFile.hpp"
+#include "acceleration/WideBVH.hpp"
+#include "cache/CacheReader.hpp"
+#include "cache/CacheWriter.hpp"
+#include "cache/format.hpp"
+#include "loaders/mesh.hpp"
+
+MeshCache::MeshCache(std::string directory)
+    : directory(std::move(directory)) {
+    /* Without the directory, the meshes are loaded without writing their cache files */
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+}
+
+TriangleMesh MeshCache::load(const std::string& path, ThreadPool& pool, BVH::Builder builder) {
+    const std::uint64_t key = get_key(path, builder);
+    const std::string cache_path = get_cache_path(key);
+
+    if(std::filesystem::exists(cache_path)) {
+        try {
+            CacheReader reader(cache_path, key);
+            TriangleMesh mesh(reader);
+            ++hit_count;
+            return mesh;
+        } catch(const std::runtime_error&) {
+            /* A cache file of another version or that was corrupted is written again below */
+        }
+    }
+
+    TriangleMesh mesh = load_mesh(path, pool);
+    mesh.build_bvh(pool, builder);
+
+    ++miss_count;
+
+    /* A cache file that cannot be written only makes the next load slower */
+    try {
+        CacheWriter writer;
+        mesh.save(writer);
+        writer.save(cache_path, key);
+    } catch(const std::runtime_error&) { }
+
+    return mesh;
+}
+
+std::string MeshCache::get_cache_path(const std::string& path, BVH::Builder builder) const {
+    return get_cache_path(get_key(path, builder));
+}
+
+std::size_t MeshCache::get_hit_count() const {
+    return hit_count;
+}
+
+std::size_t MeshCache::get_miss_count() const {
+    return miss_count;
+}
+
+std::uint64_t MeshCache::get_key(const std::string& path, BVH::Builder builder) {
+    /* Everything that changes the layout or the contents of the cached mesh */
+    const std::uint64_t settings[]{
+        cache_version, static_cast<std::uint64_t>(builder), sizeof(vec3), sizeof(BVH::Node),
+        sizeof(WideBVH<wide_bvh_width>::Node), wide_bvh_width, TriangleMesh::batch_size,
+        BVH::bin_count, BVH::max_leaf_size, BVH::max_depth
+    };
+
+    const std::string extension = std::filesystem::path(path).extension().string();
+    std::uint64_t seed = hash_bytes(std::as_bytes(std::span(settings)));
+    seed = hash_bytes(std::as_bytes(std::span(extension)), seed);
+
+    const MappedFile file(path);
+    return hash_bytes(file.get_bytes(), seed);
+}
+
+std::string MeshCache::get_cache_path(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cache", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
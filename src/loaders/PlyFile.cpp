@@ -0,0 +1,477 @@
+/***************************************************************************************************
+ * @file  PlyFile.cpp
+ * @brief Implementation of the PlyFile class
+ **************************************************************************************************/
+
+#include "loaders/PlyFile.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace {
+    /**
+     * @brief Calls a function on consecutive ranges of indices, in parallel if there is a pool.
+     * @param pool The pool, nullptr to call the function once on the whole range from this thread.
+     * @param count The number of indices.
+     * @param function Called as function(begin, end) on every range.
+     */
+    template<typename Function>
+    void for_each_chunk(ThreadPool* pool, std::size_t count, const Function& function) {
+        if(pool == nullptr) { return function(0, count); }
+
+        ThreadPool::TaskGroup group(*pool);
+        std::size_t chunk_count = 4 * pool->size();
+        for(std::size_t chunk = 0 ; chunk < chunk_count ; ++chunk) {
+            group.submit([&function, count, chunk, chunk_count] {
+                function(count * chunk / chunk_count, count * (chunk + 1) / chunk_count);
+            });
+        }
+        group.wait();
+    }
+
+    /**
+     * @brief Calls a function with a value of the C++ type of a PLY type and the endianness of the
+     * file as a compile-time constant, so that the loops the function runs are specialised on both.
+     * @param type The PLY type.
+     * @param is_big_endian Whether the file is big-endian.
+     * @param function Called as function(T(), std::bool_constant<is_big_endian>()).
+     */
+    template<typename Function>
+    void visit_type(PlyFile::Type type, bool is_big_endian, const Function& function) {
+        auto visit = [type, &function](auto swap) {
+            switch(type) {
+                case PlyFile::Type::Int8: return function(std::int8_t(), swap);
+                case PlyFile::Type::UInt8: return function(std::uint8_t(), swap);
+                case PlyFile::Type::Int16: return function(std::int16_t(), swap);
+                case PlyFile::Type::UInt16: return function(std::uint16_t(), swap);
+                case PlyFile::Type::Int32: return function(std::int32_t(), swap);
+                case PlyFile::Type::UInt32: return function(std::uint32_t(), swap);
+                case PlyFile::Type::Float32: return function(float(), swap);
+                case PlyFile::Type::Float64: return function(double(), swap);
+            }
+        };
+
+        if(is_big_endian) {
+            visit(std::true_type());
+        } else {
+            visit(std::false_type());
+        }
+    }
+
+    /**
+     * @brief Reads a scalar that may not be aligned.
+     * @tparam T The type of the scalar.
+     * @tparam Swap Whether the bytes of the scalar are swapped, for big-endian files.
+     * @param data The first byte of the scalar.
+     * @return The scalar.
+     */
+    template<typename T, bool Swap>
+    T read(const std::byte* data) {
+        std::array<std::byte, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), data, sizeof(T));
+        if constexpr(Swap) { std::ranges::reverse(bytes); }
+        return std::bit_cast<T>(bytes);
+    }
+
+    /**
+     * @brief Reads an integer of any PLY type.
+     * @param type The type of the integer.
+     * @param is_big_endian Whether the file is big-endian.
+     * @param data The first byte of the integer.
+     * @return The integer.
+     */
+    std::int64_t read_integer(PlyFile::Type type, bool is_big_endian, const std::byte* data) {
+        std::int64_t value = 0;
+        visit_type(type, is_big_endian, [&value, data](auto scalar, auto swap) {
+            value = static_cast<std::int64_t>(read<decltype(scalar), decltype(swap)::value>(data));
+        });
+        return value;
+    }
+
+    /**
+     * @brief Tests if a PLY type is an integer type.
+     * @param type The type.
+     * @return Whether the type is an integer type.
+     */
+    bool is_integer(PlyFile::Type type) {
+        return type != PlyFile::Type::Float32 && type != PlyFile::Type::Float64;
+    }
+
+    /**
+     * @brief Finds a PLY type from its name.
+     * @param name The name of the type, either its original one or its sized one.
+     * @param type The type, set if the name is known.
+     * @return Whether the name is known.
+     */
+    bool parse_type(std::string_view name, PlyFile::Type& type) {
+        static constexpr std::pair<std::string_view, PlyFile::Type> types[]{
+            { "char", PlyFile::Type::Int8 }, { "int8", PlyFile::Type::Int8 },
+            { "uchar", PlyFile::Type::UInt8 }, { "uint8", PlyFile::Type::UInt8 },
+            { "short", PlyFile::Type::Int16 }, { "int16", PlyFile::Type::Int16 },
+            { "ushort", PlyFile::Type::UInt16 }, { "uint16", PlyFile::Type::UInt16 },
+            { "int", PlyFile::Type::Int32 }, { "int32", PlyFile::Type::Int32 },
+            { "uint", PlyFile::Type::UInt32 }, { "uint32", PlyFile::Type::UInt32 },
+            { "float", PlyFile::Type::Float32 }, { "float32", PlyFile::Type::Float32 },
+            { "double", PlyFile::Type::Float64 }, { "float64", PlyFile::Type::Float64 }
+        };
+
+        for(const auto& [type_name, value] : types) {
+            if(type_name == name) {
+                type = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Splits a line of the header into its words.
+     * @param line The line.
+     * @return The words.
+     */
+    std::vector<std::string_view> split_words(std::string_view line) {
+        std::vector<std::string_view> words;
+
+        std::size_t begin = line.find_first_not_of(" \t\r");
+        while(begin != std::string_view::npos) {
+            std::size_t end = std::min(line.find_first_of(" \t\r", begin), line.size());
+            words.push_back(line.substr(begin, end - begin));
+            begin = line.find_first_not_of(" \t\r", end);
+        }
+
+        return words;
+    }
+}
+
+PlyFile::PlyFile(const std::string& path)
+    : path(path), file(path), is_big_endian(false), vertices(nullptr), faces(nullptr), index_list(nullptr),
+      triangle_count(0), has_direct_triangles(false) {
+    parse_header();
+}
+
+std::size_t PlyFile::get_vertex_count() const {
+    return vertices->count;
+}
+
+std::size_t PlyFile::get_triangle_count() const {
+    return triangle_count;
+}
+
+StridedView<std::array<float, 3>> PlyFile::get_positions() const {
+    const Property* x = find_property(*vertices, "x");
+    const Property* y = find_property(*vertices, "y");
+    const Property* z = find_property(*vertices, "z");
+
+    bool is_direct = !is_big_endian
+                     && x->type == Type::Float32 && y->type == Type::Float32 && z->type == Type::Float32
+                     && y->offset == x->offset + sizeof(float) && z->offset == y->offset + sizeof(float);
+    if(!is_direct) { return {}; }
+
+    return StridedView<std::array<float, 3>>(vertices->data + x->offset, vertices->stride, vertices->count);
+}
+
+StridedView<std::array<std::uint32_t, 3>> PlyFile::get_triangles() const {
+    if(!has_direct_triangles) { return {}; }
+
+    std::size_t count_size = get_size(index_list->count_type);
+    return StridedView<std::array<std::uint32_t, 3>>(faces->data + count_size,
+                                                      count_size + 3 * sizeof(std::uint32_t), faces->count);
+}
+
+TriangleMesh PlyFile::create_mesh() const {
+    return create_mesh(nullptr);
+}
+
+TriangleMesh PlyFile::create_mesh(ThreadPool& pool) const {
+    return create_mesh(&pool);
+}
+
+std::size_t PlyFile::get_size(Type type) {
+    switch(type) {
+        case Type::Int8:
+        case Type::UInt8:
+            return 1;
+        case Type::Int16:
+        case Type::UInt16:
+            return 2;
+        case Type::Int32:
+        case Type::UInt32:
+        case Type::Float32:
+            return 4;
+        case Type::Float64:
+            return 8;
+    }
+
+    return 0;
+}
+
+void PlyFile::parse_header() {
+    const std::string_view text = file.get_text();
+    auto fail = [this] { throw std::runtime_error("Failed to parse the header of PLY file '" + path + '\''); };
+
+    /* The header is made of lines of words and ends with the end_header line */
+    std::size_t line_begin = 0;
+    std::size_t data_offset = 0;
+    bool is_format_known = false;
+    for(std::size_t line_number = 0 ; data_offset == 0 ; ++line_number) {
+        std::size_t line_end = text.find('\n', line_begin);
+        if(line_end == std::string_view::npos) { fail(); }
+
+        std::vector<std::string_view> words = split_words(text.substr(line_begin, line_end - line_begin));
+        line_begin = line_end + 1;
+
+        if(line_number == 0) {
+            if(words.size() != 1 || words[0] != "ply") { fail(); }
+        } else if(words.empty() || words[0] == "comment" || words[0] == "obj_info") {
+            continue;
+        } else if(words[0] == "format") {
+            if(words.size() != 3) { fail(); }
+            if(words[1] == "ascii") {
+                throw std::runtime_error("Failed to read ASCII PLY file '" + path + "', only binary ones are supported");
+            }
+            if(words[1] != "binary_little_endian" && words[1] != "binary_big_endian") { fail(); }
+
+            is_big_endian = words[1] == "binary_big_endian";
+            is_format_known = true;
+        } else if(words[0] == "element") {
+            std::size_t count = 0;
+            if(words.size() != 3) { fail(); }
+            if(std::from_chars(words[2].data(), words[2].data() + words[2].size(), count).ec != std::errc()) { fail(); }
+
+            elements.push_back({ std::string(words[1]), count, {}, 0, nullptr });
+        } else if(words[0] == "property") {
+            if(elements.empty()) { fail(); }
+
+            Property property{ std::string(words.back()), Type::UInt8, Type::UInt8, false, 0 };
+            if(words.size() == 3) {
+                if(!parse_type(words[1], property.type)) { fail(); }
+            } else if(words.size() == 5 && words[1] == "list") {
+                if(!parse_type(words[2], property.count_type) || !is_integer(property.count_type)) { fail(); }
+                if(!parse_type(words[3], property.type)) { fail(); }
+                property.is_list = true;
+            } else {
+                fail();
+            }
+
+            elements.back().properties.push_back(std::move(property));
+        } else if(words[0] == "end_header") {
+            data_offset = line_begin;
+        } else {
+            fail();
+        }
+    }
+
+    if(!is_format_known) { fail(); }
+
+    for(Element& element : elements) {
+        if(element.name == "vertex") { vertices = &element; }
+        if(element.name == "face") { faces = &element; }
+
+        /* Records with lists have different sizes, so their properties have no fixed offset */
+        bool has_lists = false;
+        for(Property& property : element.properties) {
+            property.offset = element.stride;
+            element.stride += get_size(property.type);
+            has_lists = has_lists || property.is_list;
+        }
+        if(has_lists) { element.stride = 0; }
+    }
+
+    if(vertices == nullptr || vertices->stride == 0) {
+        throw std::runtime_error("Failed to find the vertices of PLY file '" + path + '\'');
+    }
+    for(const char* axis : { "x", "y", "z" }) {
+        if(find_property(*vertices, axis) == nullptr) {
+            throw std::runtime_error("Failed to find the vertex positions of PLY file '" + path + '\'');
+        }
+    }
+    if(vertices->count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Too many vertices in PLY file '" + path + '\'');
+    }
+
+    if(faces != nullptr) {
+        index_list = find_property(*faces, "vertex_indices");
+        if(index_list == nullptr) { index_list = find_property(*faces, "vertex_index"); }
+    }
+    if(index_list == nullptr || !index_list->is_list || !is_integer(index_list->type)) {
+        throw std::runtime_error("Failed to find the faces of PLY file '" + path + '\'');
+    }
+
+    /* The elements are stored one after the other */
+    std::size_t offset = data_offset;
+    for(Element& element : elements) {
+        element.data = file.get_bytes().data() + offset;
+
+        if(element.stride == 0) {
+            offset = scan_records(element) - file.get_bytes().data();
+        } else if(element.count > (file.get_size() - offset) / element.stride) {
+            throw std::runtime_error("Failed to read truncated PLY file '" + path + '\'');
+        } else {
+            offset += element.count * element.stride;
+        }
+    }
+}
+
+const std::byte* PlyFile::scan_records(const Element& element) {
+    const std::span<const std::byte> bytes = file.get_bytes();
+    const std::size_t size = bytes.size();
+    std::size_t offset = element.data - bytes.data();
+
+    auto fail = [this] { throw std::runtime_error("Failed to read truncated PLY file '" + path + '\''); };
+
+    bool has_only_triangles = true;
+    for(std::size_t record = 0 ; record < element.count ; ++record) {
+        for(const Property& property : element.properties) {
+            if(!property.is_list) {
+                offset += get_size(property.type);
+                continue;
+            }
+
+            std::size_t count_size = get_size(property.count_type);
+            if(offset + count_size > size) { fail(); }
+
+            std::int64_t item_count = read_integer(property.count_type, is_big_endian, bytes.data() + offset);
+            if(item_count < 0) { fail(); }
+            offset += count_size + item_count * get_size(property.type);
+
+            if(&property == index_list) {
+                triangle_count += item_count > 2 ? item_count - 2 : 0;
+                has_only_triangles = has_only_triangles && item_count == 3;
+            }
+        }
+
+        if(offset > size) { fail(); }
+    }
+
+    /* Lists of 3 indices have a fixed size, so the faces can be read in place */
+    if(&element == faces) {
+        has_direct_triangles = has_only_triangles && !is_big_endian && faces->properties.size() == 1
+                               && get_size(index_list->type) == sizeof(std::uint32_t);
+    }
+
+    return bytes.data() + offset;
+}
+
+const PlyFile::Property* PlyFile::find_property(const Element& element, const std::string& name) {
+    for(const Property& property : element.properties) {
+        if(property.name == name) { return &property; }
+    }
+
+    return nullptr;
+}
+
+TriangleMesh PlyFile::create_mesh(ThreadPool* pool) const {
+    std::vector<vec3> positions = read_positions(pool);
+    std::vector<std::uint32_t> indices = read_indices(pool);
+
+    if(pool == nullptr) { return TriangleMesh(std::move(positions), std::move(indices)); }
+    return TriangleMesh(std::move(positions), std::move(indices), *pool);
+}
+
+std::vector<vec3> PlyFile::read_positions(ThreadPool* pool) const {
+    std::vector<vec3> positions(vertices->count);
+
+    const StridedView<std::array<float, 3>> view = get_positions();
+    if(!view.empty()) {
+        for_each_chunk(pool, view.size(), [&positions, &view](std::size_t begin, std::size_t end) {
+            for(std::size_t vertex = begin ; vertex < end ; ++vertex) {
+                const std::array<float, 3> position = view[vertex];
+                positions[vertex] = vec3(position[0], position[1], position[2]);
+            }
+        });
+
+        return positions;
+    }
+
+    /* Every coordinate is converted by its own loop, specialised on its type */
+    const Property* axes[3]{ find_property(*vertices, "x"), find_property(*vertices, "y"), find_property(*vertices, "z") };
+    static constexpr float vec3::* coordinates[3]{ &vec3::x, &vec3::y, &vec3::z };
+
+    for_each_chunk(pool, positions.size(), [&](std::size_t begin, std::size_t end) {
+        for(int axis = 0 ; axis < 3 ; ++axis) {
+            const std::byte* data = vertices->data + axes[axis]->offset;
+            const std::size_t stride = vertices->stride;
+            float vec3::* coordinate = coordinates[axis];
+
+            visit_type(axes[axis]->type, is_big_endian, [&](auto scalar, auto swap) {
+                for(std::size_t vertex = begin ; vertex < end ; ++vertex) {
+                    positions[vertex].*coordinate = static_cast<float>(
+                        read<decltype(scalar), decltype(swap)::value>(data + vertex * stride));
+                }
+            });
+        }
+    });
+
+    return positions;
+}
+
+std::vector<std::uint32_t> PlyFile::read_indices(ThreadPool* pool) const {
+    std::vector<std::uint32_t> indices(3 * triangle_count);
+    const std::size_t vertex_count = vertices->count;
+
+    auto fail = [this] { throw std::runtime_error("Failed to read the faces of PLY file '" + path + "', an index is out of range"); };
+
+    const StridedView<std::array<std::uint32_t, 3>> view = get_triangles();
+    if(!view.empty()) {
+        for_each_chunk(pool, view.size(), [&](std::size_t begin, std::size_t end) {
+            for(std::size_t triangle = begin ; triangle < end ; ++triangle) {
+                const std::array<std::uint32_t, 3> triangle_indices = view[triangle];
+                if(std::ranges::max(triangle_indices) >= vertex_count) { fail(); }
+                std::ranges::copy(triangle_indices, indices.begin() + 3 * triangle);
+            }
+        });
+
+        return indices;
+    }
+
+    /* The faces have different sizes so they are walked in order, each split into a fan of triangles */
+    const std::byte* cursor = faces->data;
+    std::uint32_t* index = indices.data();
+    for(std::size_t face = 0 ; face < faces->count ; ++face) {
+        for(const Property& property : faces->properties) {
+            if(!property.is_list) {
+                cursor += get_size(property.type);
+                continue;
+            }
+
+            std::int64_t item_count = read_integer(property.count_type, is_big_endian, cursor);
+            cursor += get_size(property.count_type);
+
+            if(&property == index_list) {
+                visit_type(property.type, is_big_endian, [&](auto scalar, auto swap) {
+                    using T = decltype(scalar);
+
+                    std::uint32_t first = 0;
+                    std::uint32_t previous = 0;
+                    for(std::int64_t item = 0 ; item < item_count ; ++item) {
+                        auto value = static_cast<std::int64_t>(read<T, decltype(swap)::value>(cursor + item * sizeof(T)));
+                        if(value < 0 || value >= static_cast<std::int64_t>(vertex_count)) { fail(); }
+
+                        std::uint32_t current = value;
+                        if(item == 0) { first = current; }
+                        if(item >= 2) {
+                            index[0] = first;
+                            index[1] = previous;
+                            index[2] = current;
+                            index += 3;
+                        }
+
+                        previous = current;
+                    }
+                });
+            }
+
+            cursor += item_count * get_size(property.type);
+        }
+    }
+
+    return indices;
+}
@@ -0,0 +1,37 @@
+/***************************************************************************************************
+ * @file  mesh.cpp
+ * @brief Implementation of the loader of mesh files of any supported format
+ **************************************************************************************************/
+
+#include "loaders/mesh.hpp"
+
+#include <filesystem>
+#include <stdexcept>
+
+#include "loaders/PlyFile.hpp"
+#include "loaders/obj.hpp"
+
+namespace {
+    /**
+     * @brief Loads the triangles of a mesh file with the loader of its format.
+     * @param path The path of the file.
+     * @param pool The pool running the loader, nullptr to load the file from this thread.
+     * @return The mesh.
+     */
+    TriangleMesh load(const std::string& path, ThreadPool* pool) {
+        const std::filesystem::path extension = std::filesystem::path(path).extension();
+
+        if(extension == ".obj") { return pool == nullptr ? load_obj(path) : load_obj(path, *pool); }
+        if(extension == ".ply") { return pool == nullptr ? PlyFile(path).create_mesh() : PlyFile(path).create_mesh(*pool); }
+
+        throw std::runtime_error("Failed to load mesh file '" + path + "', its format is not supported");
+    }
+}
+
+TriangleMesh load_mesh(const std::string& path) {
+    return load(path, nullptr);
+}
+
+TriangleMesh load_mesh(const std::string& path, ThreadPool& pool) {
+    return load(path, &pool);
+}
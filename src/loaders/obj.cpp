@@ -0,0 +1,300 @@
+/***************************************************************************************************
+ * @file  obj.cpp
+ * @brief Implementation of the Wavefront OBJ loader
+ **************************************************************************************************/
+
+#include "loaders/obj.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "loaders/parsing.hpp"
+
+namespace {
+    constexpr std::size_t min_chunk_size = 1 << 22; ///< The minimum number of bytes parsed by a task.
+
+    /**
+     * @struct Chunk
+     * @brief A range of whole lines of the file, parsed by a single task.
+     */
+    struct Chunk {
+        const char* begin;              ///< The first character of the chunk.
+        const char* end;                ///< The character following the last line of the chunk.
+        std::size_t line_count = 0;     ///< The number of lines of the chunk.
+        std::size_t vertex_count = 0;   ///< The number of vertices the chunk defines.
+        std::size_t triangle_count = 0; ///< The number of triangles the faces of the chunk give.
+        std::size_t first_line = 0;     ///< The number of lines before the chunk.
+        std::size_t first_vertex = 0;   ///< The number of vertices defined before the chunk.
+        std::size_t first_triangle = 0; ///< The number of triangles given by the faces before the chunk.
+    };
+
+    /**
+     * @enum LineType
+     * @brief The lines of a file the loader reads, the others being skipped.
+     */
+    enum class LineType {
+        Vertex,
+        Face,
+        Other
+    };
+
+    /**
+     * @brief Finds the end of a line.
+     * @param cursor The start of the line.
+     * @param end The end of the text.
+     * @return The newline ending the line, or end.
+     */
+    const char* find_line_end(const char* cursor, const char* end) {
+        const void* newline = std::memchr(cursor, '\n', end - cursor);
+        return newline != nullptr ? static_cast<const char*>(newline) : end;
+    }
+
+    /**
+     * @brief Reads the keyword starting a line.
+     * @param cursor The start of the line, moved past the keyword of the vertices and faces.
+     * @param line_end The end of the line.
+     * @return The type of the line.
+     */
+    LineType get_line_type(const char*& cursor, const char* line_end) {
+        cursor = skip_blanks(cursor, line_end);
+        if(line_end - cursor < 2 || !is_blank(cursor[1])) { return LineType::Other; }
+
+        LineType type = cursor[0] == 'v' ? LineType::Vertex : cursor[0] == 'f' ? LineType::Face : LineType::Other;
+        cursor += 2;
+        return type;
+    }
+
+    /**
+     * @brief Tests if a cursor reached the end of the vertices of a face.
+     * @param cursor The cursor, on a character that is not a blank.
+     * @param line_end The end of the line.
+     * @return Whether the cursor is at the end of the line or at a comment.
+     */
+    bool is_face_end(const char* cursor, const char* line_end) {
+        return cursor == line_end || *cursor == '#';
+    }
+
+    /**
+     * @brief Tests if a cursor is at the end of a number.
+     * @param cursor The cursor.
+     * @param line_end The end of the line.
+     * @return Whether the cursor is at a blank, at the end of the line or at a comment.
+     */
+    bool is_number_end(const char* cursor, const char* line_end) {
+        return is_face_end(cursor, line_end) || is_blank(*cursor);
+    }
+
+    /**
+     * @brief Counts the vertices of a face, which are separated by blanks.
+     * @param cursor The character following the keyword of the face.
+     * @param line_end The end of the line.
+     * @return The number of vertices.
+     */
+    std::size_t count_face_vertices(const char* cursor, const char* line_end) {
+        std::size_t count = 0;
+
+        for(cursor = skip_blanks(cursor, line_end) ; !is_face_end(cursor, line_end) ; cursor = skip_blanks(cursor, line_end)) {
+            ++count;
+            while(cursor != line_end && !is_blank(*cursor)) { ++cursor; }
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Splits a text into chunks of about the same size that end at line boundaries.
+     * @param text The text.
+     * @param chunk_count The number of chunks to aim for, fewer being made if the lines are long.
+     * @return The chunks.
+     */
+    std::vector<Chunk> split_into_chunks(std::string_view text, std::size_t chunk_count) {
+        const char* const begin = text.data();
+        const char* const end = begin + text.size();
+
+        std::vector<Chunk> chunks;
+        const char* chunk_begin = begin;
+        for(std::size_t chunk = 1 ; chunk <= chunk_count && chunk_begin != end ; ++chunk) {
+            const char* chunk_end = end;
+            if(chunk < chunk_count) {
+                chunk_end = find_line_end(std::max(chunk_begin, begin + text.size() * chunk / chunk_count), end);
+                chunk_end += chunk_end != end;
+            }
+
+            chunks.push_back({ chunk_begin, chunk_end });
+            chunk_begin = chunk_end;
+        }
+
+        return chunks;
+    }
+
+    /**
+     * @brief Calls a function on every chunk, in parallel if there is a pool.
+     * @param pool The pool, nullptr to call the function from this thread.
+     * @param chunks The chunks.
+     * @param function Called as function(chunk) on every chunk.
+     */
+    template<typename Function>
+    void for_each_chunk(ThreadPool* pool, std::vector<Chunk>& chunks, const Function& function) {
+        if(pool == nullptr || chunks.size() == 1) {
+            for(Chunk& chunk : chunks) { function(chunk); }
+            return;
+        }
+
+        ThreadPool::TaskGroup group(*pool);
+        for(Chunk& chunk : chunks) { group.submit([&function, &chunk] { function(chunk); }); }
+        group.wait();
+    }
+
+    /**
+     * @brief Counts the lines, vertices and triangles of a chunk.
+     * @param chunk The chunk.
+     */
+    void count_chunk(Chunk& chunk) {
+        for(const char* line = chunk.begin ; line != chunk.end ; ++chunk.line_count) {
+            const char* line_end = find_line_end(line, chunk.end);
+            const char* cursor = line;
+
+            switch(get_line_type(cursor, line_end)) {
+                case LineType::Vertex:
+                    ++chunk.vertex_count;
+                    break;
+                case LineType::Face: {
+                    std::size_t vertex_count = count_face_vertices(cursor, line_end);
+                    chunk.triangle_count += vertex_count > 2 ? vertex_count - 2 : 0;
+                    break;
+                }
+                case LineType::Other:
+                    break;
+            }
+
+            line = line_end + (line_end != chunk.end);
+        }
+    }
+
+    /**
+     * @brief Parses the vertices and faces of a chunk into the arrays of the mesh, at the offsets the
+     * previous chunks leave.
+     * @param chunk The counted chunk.
+     * @param positions The positions of all the vertices of the file.
+     * @param indices The indices of all the triangles of the file.
+     * @param path The path of the file, for the errors.
+     */
+    void parse_chunk(const Chunk& chunk, std::vector<vec3>& positions, std::vector<std::uint32_t>& indices,
+                     const std::string& path) {
+        std::size_t line_number = chunk.first_line;
+        std::size_t vertex = chunk.first_vertex;
+        std::uint32_t* index = indices.data() + 3 * chunk.first_triangle;
+
+        auto fail = [&] {
+            throw std::runtime_error("Failed to parse line " + std::to_string(line_number) + " of OBJ file '" + path + '\'');
+        };
+
+        for(const char* line = chunk.begin ; line != chunk.end ; ) {
+            ++line_number;
+            const char* line_end = find_line_end(line, chunk.end);
+            const char* cursor = line;
+
+            switch(get_line_type(cursor, line_end)) {
+                case LineType::Vertex: {
+                    float coordinates[3];
+                    for(float& coordinate : coordinates) {
+                        cursor = skip_blanks(cursor, line_end);
+                        if(!parse_float(cursor, line_end, coordinate) || !is_number_end(cursor, line_end)) { fail(); }
+                    }
+
+                    positions[vertex++] = vec3(coordinates[0], coordinates[1], coordinates[2]);
+                    break;
+                }
+                case LineType::Face: {
+                    /* The face is split into a fan of triangles around its first vertex */
+                    std::uint32_t first = 0;
+                    std::uint32_t previous = 0;
+                    std::size_t count = 0;
+
+                    for(cursor = skip_blanks(cursor, line_end) ; !is_face_end(cursor, line_end) ; cursor = skip_blanks(cursor, line_end)) {
+                        std::int64_t value;
+                        if(!parse_integer(cursor, line_end, value)) { fail(); }
+
+                        std::int64_t resolved = value > 0 ? value - 1 : static_cast<std::int64_t>(vertex) + value;
+                        if(value == 0 || resolved < 0 || resolved >= static_cast<std::int64_t>(positions.size())) { fail(); }
+
+                        /* The texture coordinate and normal indices are not needed */
+                        while(cursor != line_end && !is_blank(*cursor)) { ++cursor; }
+
+                        std::uint32_t current = resolved;
+                        if(count == 0) { first = current; }
+                        if(count >= 2) {
+                            index[0] = first;
+                            index[1] = previous;
+                            index[2] = current;
+                            index += 3;
+                        }
+
+                        previous = current;
+                        ++count;
+                    }
+
+                    if(count < 3) { fail(); }
+                    break;
+                }
+                case LineType::Other:
+                    break;
+            }
+
+            line = line_end + (line_end != chunk.end);
+        }
+    }
+
+    /**
+     * @brief Loads the triangles of a Wavefront OBJ file.
+     * @param path The path of the file.
+     * @param pool The pool parsing the chunks of the file, nullptr to parse it as a single chunk.
+     * @return The mesh.
+     */
+    TriangleMesh load(const std::string& path, ThreadPool* pool) {
+        const MappedFile file(path);
+        const std::string_view text = file.get_text();
+
+        std::size_t chunk_count = pool == nullptr ? 1 : std::clamp<std::size_t>(text.size() / min_chunk_size, 1, 4 * pool->size());
+        std::vector<Chunk> chunks = split_into_chunks(text, chunk_count);
+
+        for_each_chunk(pool, chunks, count_chunk);
+
+        /* Every chunk writes after the vertices and triangles of the previous ones */
+        std::size_t line_count = 0;
+        std::size_t vertex_count = 0;
+        std::size_t triangle_count = 0;
+        for(Chunk& chunk : chunks) {
+            chunk.first_line = std::exchange(line_count, line_count + chunk.line_count);
+            chunk.first_vertex = std::exchange(vertex_count, vertex_count + chunk.vertex_count);
+            chunk.first_triangle = std::exchange(triangle_count, triangle_count + chunk.triangle_count);
+        }
+
+        if(vertex_count > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Too many vertices in OBJ file '" + path + '\'');
+        }
+
+        std::vector<vec3> positions(vertex_count);
+        std::vector<std::uint32_t> indices(3 * triangle_count);
+        for_each_chunk(pool, chunks, [&](const Chunk& chunk) { parse_chunk(chunk, positions, indices, path); });
+
+        if(pool == nullptr) { return TriangleMesh(std::move(positions), std::move(indices)); }
+        return TriangleMesh(std::move(positions), std::move(indices), *pool);
+    }
+}
+
+TriangleMesh load_obj(const std::string& path) {
+    return load(path, nullptr);
+}
+
+TriangleMesh load_obj(const std::string& path, ThreadPool& pool) {
+    return load(path, &pool);
+}
@@ -0,0 +1,304 @@
+/***************************************************************************************************
+ * @file  scene.cpp
+ * @brief Implementation of the scene description loader
+ **************************************************************************************************/
+
+#include "loaders/scene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Image.hpp"
+#include "MappedFile.hpp"
+#include "cache/MeshCache.hpp"
+#include "loaders/mesh.hpp"
+#include "loaders/parsing.hpp"
+#include "maths/geometry.hpp"
+#include "maths/mat4.hpp"
+
+namespace {
+    /**
+     * @struct MeshReference
+     * @brief A mesh or an instance of a mesh, loaded once the whole file is parsed.
+     */
+    struct MeshReference {
+        std::string path;       ///< The path of the mesh file.
+        std::uint32_t material; ///< The material of the mesh or of the instance.
+        bool is_instance;       ///< Whether the mesh is instanced.
+        mat4 transform;         ///< The transform of an instance.
+    };
+
+    /**
+     * @brief Tests if a cursor reached the end of the arguments of a line.
+     * @param cursor The cursor, on a character that is not a blank.
+     * @param line_end The end of the line.
+     * @return Whether the cursor is at the end of the line or at a comment.
+     */
+    bool is_line_end(const char* cursor, const char* line_end) {
+        return cursor == line_end || *cursor == '#';
+    }
+
+    /**
+     * @brief Tests if a cursor is at the end of a word or of a number.
+     * @param cursor The cursor.
+     * @param line_end The end of the line.
+     * @return Whether the cursor is at a blank, at the end of the line or at a comment.
+     */
+    bool is_word_end(const char* cursor, const char* line_end) {
+        return is_line_end(cursor, line_end) || is_blank(*cursor);
+    }
+
+    /**
+     * @brief Reads the next word of a line, in place.
+     * @param cursor The cursor, moved past the word.
+     * @param line_end The end of the line.
+     * @return The word, empty at the end of the line.
+     */
+    std::string_view read_word(const char*& cursor, const char* line_end) {
+        cursor = skip_blanks(cursor, line_end);
+        if(is_line_end(cursor, line_end)) { return {}; }
+
+        const char* begin = cursor;
+        while(!is_word_end(cursor, line_end)) { ++cursor; }
+        return { begin, static_cast<std::size_t>(cursor - begin) };
+    }
+
+    /**
+     * @brief Reads the next floats of a line.
+     * @param cursor The cursor, moved past the floats.
+     * @param line_end The end of the line.
+     * @param values Where the floats are written.
+     * @return Whether there were as many floats as values.
+     */
+    bool read_floats(const char*& cursor, const char* line_end, std::initializer_list<float*> values) {
+        for(float* value : values) {
+            cursor = skip_blanks(cursor, line_end);
+            if(!parse_float(cursor, line_end, *value) || !is_word_end(cursor, line_end)) { return false; }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Reads the next vec3 of a line, as three floats.
+     * @param cursor The cursor, moved past the vec3.
+     * @param line_end The end of the line.
+     * @param vec Where the vec3 is written.
+     * @return Whether there were three floats.
+     */
+    bool read_vec3(const char*& cursor, const char* line_end, vec3& vec) {
+        return read_floats(cursor, line_end, { &vec.x, &vec.y, &vec.z });
+    }
+
+    /**
+     * @brief Reads the next positive integer of a line.
+     * @param cursor The cursor, moved past the integer.
+     * @param line_end The end of the line.
+     * @param value Where the integer is written.
+     * @return Whether there was an integer between 1 and the largest unsigned int.
+     */
+    bool read_count(const char*& cursor, const char* line_end, unsigned int& value) {
+        cursor = skip_blanks(cursor, line_end);
+
+        std::int64_t integer;
+        if(!parse_integer(cursor, line_end, integer) || !is_word_end(cursor, line_end)) { return false; }
+        if(integer < 1 || integer > std::numeric_limits<unsigned int>::max()) { return false; }
+
+        value = integer;
+        return true;
+    }
+}
+
+Scene load_scene(const std::string& path, ThreadPool& pool) {
+    const MappedFile file(path);
+    const std::string_view text = file.get_text();
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int samples = 1;
+
+    bool has_camera = false;
+    vec3 position;
+    vec3 look_at;
+    vec3 up;
+    float fov = 0.0f;
+
+    std::optional<std::pair<vec3, vec3>> sky;
+    std::string_view output;
+    std::string_view cache_directory;
+    BVH::Builder builder = BVH::Builder::SAH;
+
+    /* The primitives that have no material use the first one, which is white */
+    std::vector<Material> materials{ Material() };
+    std::vector<std::pair<std::string_view, std::uint32_t>> material_names;
+
+    SphereSet spheres;
+    std::vector<MeshReference> references;
+
+    std::size_t line_number = 0;
+    auto fail = [&] {
+        throw std::runtime_error("Failed to parse line " + std::to_string(line_number) + " of scene file '" + path + '\'');
+    };
+
+    const char* const text_end = text.data() + text.size();
+    for(const char* line = text.data() ; line != text_end ; ) {
+        ++line_number;
+        const void* newline = std::memchr(line, '\n', text_end - line);
+        const char* line_end = newline != nullptr ? static_cast<const char*>(newline) : text_end;
+        const char* cursor = line;
+
+        /* A primitive may end with the name of its material */
+        auto read_material = [&]() -> std::uint32_t {
+            std::string_view name = read_word(cursor, line_end);
+            if(name.empty()) { return 0; }
+
+            auto found = std::ranges::find(material_names, name, &std::pair<std::string_view, std::uint32_t>::first);
+            if(found == material_names.end()) {
+                throw std::runtime_error("Failed to find material '" + std::string(name) + "' used on line "
+                                         + std::to_string(line_number) + " of scene file '" + path + '\'');
+            }
+
+            return found->second;
+        };
+
+        const std::string_view directive = read_word(cursor, line_end);
+        if(directive.empty()) {
+            /* Blank line or comment */
+        } else if(directive == "resolution") {
+            if(!read_count(cursor, line_end, width) || !read_count(cursor, line_end, height)) { fail(); }
+        } else if(directive == "samples") {
+            if(!read_count(cursor, line_end, samples)) { fail(); }
+        } else if(directive == "output") {
+            output = read_word(cursor, line_end);
+            if(output.empty()) { fail(); }
+        } else if(directive == "camera") {
+            if(!read_vec3(cursor, line_end, position) || !read_vec3(cursor, line_end, look_at)
+               || !read_vec3(cursor, line_end, up) || !read_floats(cursor, line_end, { &fov })) {
+                fail();
+            }
+
+            /* The basis of the camera needs a view direction that is not along the up vector */
+            if(!(fov > 0.0f && fov < 180.0f) || cross(up, position - look_at) == vec3(0.0f)) { fail(); }
+            has_camera = true;
+        } else if(directive == "sky") {
+            sky.emplace();
+            if(!read_vec3(cursor, line_end, sky->first) || !read_vec3(cursor, line_end, sky->second)) { fail(); }
+        } else if(directive == "builder") {
+            std::string_view name = read_word(cursor, line_end);
+            if(name == "sah") {
+                builder = BVH::Builder::SAH;
+            } else if(name == "morton") {
+                builder = BVH::Builder::Morton;
+            } else {
+                fail();
+            }
+        } else if(directive == "cache") {
+            cache_directory = read_word(cursor, line_end);
+            if(cache_directory.empty()) { fail(); }
+        } else if(directive == "material") {
+            std::string_view name = read_word(cursor, line_end);
+            Material material;
+            if(name.empty() || !read_vec3(cursor, line_end, material.albedo)) { fail(); }
+            if(std::ranges::find(material_names, name, &std::pair<std::string_view, std::uint32_t>::first) != material_names.end()) {
+                fail();
+            }
+
+            material_names.emplace_back(name, materials.size());
+            materials.push_back(material);
+        } else if(directive == "sphere") {
+            vec3 center;
+            float radius;
+            if(!read_vec3(cursor, line_end, center) || !read_floats(cursor, line_end, { &radius })) { fail(); }
+            if(!(radius > 0.0f) || std::isinf(radius)) { fail(); }
+            spheres.add(center, radius, read_material());
+        } else if(directive == "mesh") {
+            std::string_view mesh_path = read_word(cursor, line_end);
+            if(mesh_path.empty()) { fail(); }
+            references.push_back({ (directory / mesh_path).string(), read_material(), false, mat4() });
+        } else if(directive == "instance") {
+            std::string_view mesh_path = read_word(cursor, line_end);
+            vec3 translation;
+            float angle;
+            vec3 axis;
+            vec3 factors;
+            if(mesh_path.empty() || !read_vec3(cursor, line_end, translation) || !read_floats(cursor, line_end, { &angle })
+               || !read_vec3(cursor, line_end, axis) || !read_vec3(cursor, line_end, factors)) {
+                fail();
+            }
+
+            /* Otherwise the rotation is undefined or the transform cannot be inverted */
+            if(axis == vec3(0.0f) || factors.x == 0.0f || factors.y == 0.0f || factors.z == 0.0f) { fail(); }
+
+            mat4 transform = translate(translation) * rotate(angle * std::numbers::pi_v<float> / 180.0f, axis) * scale(factors);
+            references.push_back({ (directory / mesh_path).string(), read_material(), true, transform });
+        } else {
+            fail();
+        }
+
+        if(!is_line_end(skip_blanks(cursor, line_end), line_end)) { fail(); }
+        line = line_end + (line_end != text_end);
+    }
+
+    if(width == 0 || !has_camera) {
+        throw std::runtime_error("Failed to load scene file '" + path + "', it has no resolution or no camera");
+    }
+
+    Scene scene(width, height, samples, Camera(position, look_at, up, fov, width, height));
+    scene.materials = std::move(materials);
+    if(sky.has_value()) {
+        scene.sky_bottom = sky->first;
+        scene.sky_top = sky->second;
+    }
+    if(!output.empty()) { scene.output = output; }
+
+    /* An unsupported output format fails before the render rather than after it */
+    Image::get_format(scene.output);
+
+    scene.spheres = std::move(spheres);
+    scene.spheres.build_bvh(pool, builder);
+
+    std::optional<MeshCache> cache;
+    if(!cache_directory.empty()) { cache.emplace(std::string(cache_directory)); }
+
+    auto load_mesh_with_bvh = [&](const std::string& mesh_path) {
+        if(cache.has_value()) { return cache->load(mesh_path, pool, builder); }
+
+        TriangleMesh mesh = load_mesh(mesh_path, pool);
+        mesh.build_bvh(pool, builder);
+        return mesh;
+    };
+
+    /* Every instanced mesh is loaded once, however many instances it has */
+    std::vector<std::pair<std::string_view, std::uint32_t>> instanced_meshes;
+    for(const MeshReference& reference : references) {
+        if(!reference.is_instance) {
+            scene.meshes.push_back(load_mesh_with_bvh(reference.path));
+            scene.meshes.back().set_material(reference.material);
+            continue;
+        }
+
+        auto found = std::ranges::find(instanced_meshes, reference.path, &std::pair<std::string_view, std::uint32_t>::first);
+        if(found == instanced_meshes.end()) {
+            found = instanced_meshes.emplace(found, reference.path, scene.instances.add_mesh(load_mesh_with_bvh(reference.path)));
+        }
+
+        scene.instances.add_instance(found->second, reference.transform, reference.material);
+    }
+
+    scene.instances.build_bvh(pool, builder);
+
+    return scene;
+}
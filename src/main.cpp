@@ -3,53 +3,70 @@
  * @brief Contains the main program of the project
  **************************************************************************************************/
 
-#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Image.hpp"
-#include "Ray.hpp"
-#include "maths/geometry.hpp"
-#include "maths/vec2.hpp"
+#include "ImageWriter.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "loaders/scene.hpp"
 
-template<typename T>
-T lerp(T value_at_0, T value_at_1, float t) {
-    return (1.0f - t) * value_at_0 + t * value_at_1;
-}
-
-void run() {
-    /* ---- Init ---- */
-    unsigned int width = 1025;
-    unsigned int height = 512;
-    Image image(width, height);
+/**
+ * @brief Renders scene description files one after the other, sharing the threads between them.
+ * @param scene_paths The paths of the scene files.
+ */
+void run(const std::vector<std::string>& scene_paths) {
+    ThreadPool pool;
+    ImageWriter writer;
+    Renderer renderer(pool);
 
-    vec3 camera(0.0f, 0.0f, 0.0f);
+    for(const std::string& scene_path : scene_paths) {
+        /* ---- Init ---- */
+        Scene scene = [&pool, &scene_path] {
+            PROFILE_PHASE(SETUP);
+            return load_scene(scene_path, pool);
+        }();
 
-    /* ---- Do Stuff ---- */
-    vec3 extremity(0.0f, 0.0f, -1.0f);
+        Image image(scene.width, scene.height);
 
-    for(unsigned int j = 0 ; j < height ; ++j) {
-        for(unsigned int i = 0 ; i < width ; ++i) {
-            /* Extremity & Ray */
-            extremity.x = (2.0f * i - width) / height;
-            extremity.y = (2.0f * j - height) / height;
+        /* ---- Render ---- */
+        {
+            PROFILE_PHASE(RENDER);
+            renderer.render(scene, image);
+        }
 
-            Ray ray(camera, extremity - camera);
+        /* ---- Write Image ---- */
+        writer.submit(std::move(image), scene.output);
+    }
 
-            /* Pixel Color */
-            vec3& pixel = image(i, j);
+    writer.wait();
 
-            pixel = lerp(vec3(1.0f), vec3(0.5f, 0.7f, 1.0f), 0.5f + 0.5f * ray.direction.y);
-        }
+    /* ---- Profiling Report ---- */
+#ifdef PROFILING
+    std::vector<ThreadPool::WorkerStats> stats = pool.get_stats();
+    for(unsigned int i = 0 ; i < stats.size() ; ++i) {
+        std::printf("Worker %2u : %5.1f%% busy, %llu tiles (%llu stolen)\n", i, 100.0 * stats[i].utilisation,
+                    static_cast<unsigned long long>(stats[i].tasks_executed),
+                    static_cast<unsigned long long>(stats[i].tasks_stolen));
     }
+#endif
 
-    /* ---- Write Image ---- */
-    image.write();
+    PROFILE_REPORT(std::cout);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
-        run();
+        std::vector<std::string> scene_paths(argv + 1, argv + argc);
+        if(scene_paths.empty()) { scene_paths.emplace_back("data/scenes/default.scene"); }
+
+        run(scene_paths);
     } catch(const std::exception& exception) {
         std::cerr << "ERROR : " << exception.what() << '\n';
         return -1;
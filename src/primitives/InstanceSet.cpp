@@ -0,0 +1,163 @@
+/***************************************************************************************************
+ * @file  InstanceSet.cpp
+ * @brief Implementation of the InstanceSet class
+ **************************************************************************************************/
+
+#include "primitives/InstanceSet.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "maths/geometry.hpp"
+
+std::uint32_t InstanceSet::add_mesh(TriangleMesh mesh) {
+    meshes.push_back(std::move(mesh));
+    return meshes.size() - 1;
+}
+
+void InstanceSet::add_instance(std::uint32_t mesh, const mat4& transform, std::uint32_t material) {
+    if(mesh >= meshes.size()) {
+        throw std::out_of_range("Failed to add an instance of mesh " + std::to_string(mesh) + ", there are "
+                                + std::to_string(meshes.size()) + " meshes");
+    }
+
+    /* A singular transform gives infinite or NaN cofactors, which would make every ray miss or hit
+     * everywhere */
+    const mat4 inverse_transform = inverse(transform);
+    for(const vec4& column : inverse_transform.columns) {
+        if(!std::isfinite(column.x) || !std::isfinite(column.y) || !std::isfinite(column.z) || !std::isfinite(column.w)) {
+            throw std::invalid_argument("Failed to add an instance of mesh " + std::to_string(mesh)
+                                        + ", its transform is not invertible");
+        }
+    }
+
+    instances.emplace_back(mesh, transform, inverse_transform, material);
+}
+
+std::size_t InstanceSet::size() const {
+    return instances.size();
+}
+
+const std::vector<TriangleMesh>& InstanceSet::get_meshes() const {
+    return meshes;
+}
+
+const InstanceSet::Instance& InstanceSet::get_instance(std::size_t instance) const {
+    return instances[instance];
+}
+
+AABB InstanceSet::get_bounds(std::size_t instance) const {
+    const Instance& placed = instances[instance];
+    const AABB mesh_bounds = meshes[placed.mesh].get_bvh().get_bounds();
+    if(mesh_bounds.is_empty()) { return AABB(); }
+
+    AABB bounds;
+    for(unsigned int corner = 0 ; corner < 8 ; ++corner) {
+        vec3 point(corner & 1 ? mesh_bounds.max.x : mesh_bounds.min.x,
+                   corner & 2 ? mesh_bounds.max.y : mesh_bounds.min.y,
+                   corner & 4 ? mesh_bounds.max.z : mesh_bounds.min.z);
+        bounds.grow(transform_point(placed.object_to_world, point));
+    }
+
+    return bounds;
+}
+
+void InstanceSet::build_bvh(BVH::Builder builder) {
+    for(TriangleMesh& mesh : meshes) {
+        if(mesh.get_bvh().get_nodes().empty()) { mesh.build_bvh(builder); }
+    }
+
+    bvh = BVH(get_all_bounds(), builder);
+    wide_bvh = WideBVH<wide_bvh_width>(bvh);
+}
+
+void InstanceSet::build_bvh(ThreadPool& pool, BVH::Builder builder) {
+    for(TriangleMesh& mesh : meshes) {
+        if(mesh.get_bvh().get_nodes().empty()) { mesh.build_bvh(pool, builder); }
+    }
+
+    bvh = BVH(get_all_bounds(), pool, builder);
+    wide_bvh = WideBVH<wide_bvh_width>(bvh);
+}
+
+const BVH& InstanceSet::get_bvh() const {
+    return bvh;
+}
+
+std::size_t InstanceSet::get_memory_usage() const {
+    std::size_t usage = instances.size() * sizeof(Instance)
+                        + bvh.get_nodes().size() * sizeof(BVH::Node)
+                        + wide_bvh.get_nodes().size() * sizeof(WideBVH<wide_bvh_width>::Node)
+                        + wide_bvh.get_primitives().size() * sizeof(std::uint32_t);
+
+    for(const TriangleMesh& mesh : meshes) { usage += mesh.get_memory_usage(); }
+
+    return usage;
+}
+
+bool InstanceSet::intersect(std::uint32_t instance, const Ray& ray, Hit& hit) const {
+    float scale;
+    const Ray object_ray = to_object_space(instances[instance], ray, scale);
+
+    Hit object_hit;
+    object_hit.distance = hit.distance * scale;
+    if(!meshes[instances[instance].mesh].trace(object_ray, object_hit)) { return false; }
+
+    /* Rounding may bring the distance back to the current one */
+    float distance = object_hit.distance / scale;
+    if(!(distance < hit.distance)) { return false; }
+
+    hit.distance = distance;
+    hit.primitive = object_hit.primitive;
+    hit.instance = instance;
+    return true;
+}
+
+bool InstanceSet::trace(const Ray& ray, Hit& hit) const {
+    return wide_bvh.intersect(ray, hit, [this](std::uint32_t instance, const Ray& ray, Hit& hit) {
+        return intersect(instance, ray, hit);
+    });
+}
+
+bool InstanceSet::occluded(const Ray& ray, float max_distance) const {
+    return wide_bvh.occluded(ray, max_distance, [this](std::uint32_t instance, const Ray& ray, Hit& hit) {
+        float scale;
+        const Ray object_ray = to_object_space(instances[instance], ray, scale);
+
+        return meshes[instances[instance].mesh].occluded(object_ray, hit.distance * scale);
+    });
+}
+
+vec3 InstanceSet::get_normal(const Ray& ray, const Hit& hit) const {
+    const Instance& instance = instances[hit.instance];
+
+    float scale;
+    const Ray object_ray = to_object_space(instance, ray, scale);
+    vec3 normal = meshes[instance.mesh].get_normal(object_ray, hit);
+
+    /* Normals are transformed by the inverse transpose of the transform */
+    return normalize(transform_vector(transpose(instance.world_to_object), normal));
+}
+
+Ray InstanceSet::to_object_space(const Instance& instance, const Ray& ray, float& scale) {
+    vec3 direction = transform_vector(instance.world_to_object, ray.direction);
+    scale = length(direction);
+
+    Ray object_ray;
+    object_ray.origin = transform_point(instance.world_to_object, ray.origin);
+    object_ray.direction = direction / scale;
+
+    return object_ray;
+}
+
+std::vector<AABB> InstanceSet::get_all_bounds() const {
+    std::vector<AABB> bounds(instances.size());
+    for(std::size_t instance = 0 ; instance < instances.size() ; ++instance) {
+        bounds[instance] = get_bounds(instance);
+    }
+
+    return bounds;
+}
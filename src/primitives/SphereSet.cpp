@@ -0,0 +1,238 @@
+/***************************************************************************************************
+ * @file  SphereSet.cpp
+ * @brief Implementation of the SphereSet class
+ **************************************************************************************************/
+
+#include "primitives/SphereSet.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Profiler.hpp"
+#include "maths/geometry.hpp"
+
+void SphereSet::add(const vec3& center, float radius, std::uint32_t material) {
+    /* The padding spheres have a NaN radius so that they are never hit */
+    if(count % batch_size == 0) {
+        center_x.resize(count + batch_size, 0.0f);
+        center_y.resize(count + batch_size, 0.0f);
+        center_z.resize(count + batch_size, 0.0f);
+        this->radius.resize(count + batch_size, std::numeric_limits<float>::quiet_NaN());
+    }
+
+    center_x[count] = center.x;
+    center_y[count] = center.y;
+    center_z[count] = center.z;
+    this->radius[count] = radius;
+    materials.push_back(material);
+    ++count;
+}
+
+std::size_t SphereSet::size() const {
+    return count;
+}
+
+vec3 SphereSet::get_center(std::size_t sphere) const {
+    return vec3(center_x[sphere], center_y[sphere], center_z[sphere]);
+}
+
+float SphereSet::get_radius(std::size_t sphere) const {
+    return radius[sphere];
+}
+
+std::uint32_t SphereSet::get_material(std::size_t sphere) const {
+    return materials[sphere];
+}
+
+AABB SphereSet::get_bounds(std::size_t sphere) const {
+    vec3 center = get_center(sphere);
+    return AABB(center - radius[sphere], center + radius[sphere]);
+}
+
+void SphereSet::build_bvh(BVH::Builder builder) {
+    bvh = BVH(get_all_bounds(), builder);
+    wide_bvh = WideBVH<wide_bvh_width>(bvh);
+}
+
+void SphereSet::build_bvh(ThreadPool& pool, BVH::Builder builder) {
+    bvh = BVH(get_all_bounds(), pool, builder);
+    wide_bvh = WideBVH<wide_bvh_width>(bvh);
+}
+
+const BVH& SphereSet::get_bvh() const {
+    return bvh;
+}
+
+const WideBVH<wide_bvh_width>& SphereSet::get_wide_bvh() const {
+    return wide_bvh;
+}
+
+bool SphereSet::intersect(const Ray& ray, Hit& hit) const {
+    PROFILE_COUNT(INTERSECTIONS_TESTED, count);
+
+#ifdef MATHS_SIMD_AVX2
+    const __m256 origin_x = _mm256_set1_ps(ray.origin.x);
+    const __m256 origin_y = _mm256_set1_ps(ray.origin.y);
+    const __m256 origin_z = _mm256_set1_ps(ray.origin.z);
+    const __m256 direction_x = _mm256_set1_ps(ray.direction.x);
+    const __m256 direction_y = _mm256_set1_ps(ray.direction.y);
+    const __m256 direction_z = _mm256_set1_ps(ray.direction.z);
+    const __m256 min_distance = _mm256_set1_ps(Hit::min_distance);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i step = _mm256_set1_epi32(batch_size);
+
+    __m256 closest = _mm256_set1_ps(hit.distance);
+    __m256i closest_sphere = _mm256_set1_epi32(-1);
+    __m256i sphere = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for(std::size_t first = 0 ; first < count ; first += batch_size) {
+        __m256 oc_x = _mm256_sub_ps(origin_x, _mm256_load_ps(center_x.data() + first));
+        __m256 oc_y = _mm256_sub_ps(origin_y, _mm256_load_ps(center_y.data() + first));
+        __m256 oc_z = _mm256_sub_ps(origin_z, _mm256_load_ps(center_z.data() + first));
+        __m256 radii = _mm256_load_ps(radius.data() + first);
+
+        /* Solves t² + 2bt + c = 0 since the direction is normalized */
+        __m256 b = _mm256_fmadd_ps(oc_x, direction_x, _mm256_fmadd_ps(oc_y, direction_y, _mm256_mul_ps(oc_z, direction_z)));
+        __m256 c = _mm256_fmadd_ps(oc_x, oc_x, _mm256_fmadd_ps(oc_y, oc_y, _mm256_fmsub_ps(oc_z, oc_z, _mm256_mul_ps(radii, radii))));
+        __m256 discriminant = _mm256_fmsub_ps(b, b, c);
+        __m256 root = _mm256_sqrt_ps(discriminant);
+
+        __m256 near = _mm256_sub_ps(_mm256_sub_ps(zero, b), root);
+        __m256 far = _mm256_sub_ps(root, b);
+        __m256 distance = _mm256_blendv_ps(near, far, _mm256_cmp_ps(near, min_distance, _CMP_LE_OQ));
+
+        __m256 mask = _mm256_and_ps(
+            _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ),
+            _mm256_and_ps(_mm256_cmp_ps(distance, min_distance, _CMP_GT_OQ), _mm256_cmp_ps(distance, closest, _CMP_LT_OQ))
+        );
+
+        closest = _mm256_blendv_ps(closest, distance, mask);
+        closest_sphere = _mm256_castps_si256(_mm256_blendv_ps(
+            _mm256_castsi256_ps(closest_sphere), _mm256_castsi256_ps(sphere), mask
+        ));
+        sphere = _mm256_add_epi32(sphere, step);
+    }
+
+    alignas(32) float distances[batch_size];
+    alignas(32) int spheres[batch_size];
+    _mm256_store_ps(distances, closest);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(spheres), closest_sphere);
+#else
+    /* The lanes of the AVX2 kernel, without branches so that the compiler vectorises them. The
+     * discriminant is clamped so that the square root never has to report a domain error. */
+    alignas(32) float distances[batch_size];
+    alignas(32) int spheres[batch_size];
+    for(std::size_t lane = 0 ; lane < batch_size ; ++lane) {
+        distances[lane] = hit.distance;
+        spheres[lane] = -1;
+    }
+
+    for(std::size_t first = 0 ; first < count ; first += batch_size) {
+        for(std::size_t lane = 0 ; lane < batch_size ; ++lane) {
+            float oc_x = ray.origin.x - center_x[first + lane];
+            float oc_y = ray.origin.y - center_y[first + lane];
+            float oc_z = ray.origin.z - center_z[first + lane];
+            float radius_squared = radius[first + lane] * radius[first + lane];
+
+            float b = oc_x * ray.direction.x + oc_y * ray.direction.y + oc_z * ray.direction.z;
+            float c = oc_x * oc_x + oc_y * oc_y + oc_z * oc_z - radius_squared;
+            float discriminant = b * b - c;
+            float root = std::sqrt(discriminant > 0.0f ? discriminant : 0.0f);
+
+            /* The near root, or the far one from inside the sphere, selected before the subtraction
+             * that could trap so that the selection is not turned back into a branch */
+            float distance = (-b - root <= Hit::min_distance ? root : -root) - b;
+
+            bool is_closer = (discriminant >= 0.0f) & (distance > Hit::min_distance) & (distance < distances[lane]);
+            distances[lane] = is_closer ? distance : distances[lane];
+            spheres[lane] = is_closer ? static_cast<int>(first + lane) : spheres[lane];
+        }
+    }
+#endif
+
+    /* Closest lane */
+    bool found = false;
+    for(std::size_t lane = 0 ; lane < batch_size ; ++lane) {
+        if(spheres[lane] >= 0 && distances[lane] < hit.distance) {
+            hit.distance = distances[lane];
+            hit.primitive = spheres[lane];
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool SphereSet::intersect_reference(const Ray& ray, Hit& hit) const {
+    bool found = false;
+
+    for(std::size_t sphere = 0 ; sphere < count ; ++sphere) {
+        vec3 oc = ray.origin - get_center(sphere);
+
+        float b = dot(oc, ray.direction);
+        float c = dot(oc, oc) - radius[sphere] * radius[sphere];
+        float discriminant = b * b - c;
+        if(discriminant < 0.0f) { continue; }
+
+        float root = std::sqrt(discriminant);
+        float distance = -b - root;
+        if(distance <= Hit::min_distance) { distance = root - b; }
+
+        if(distance > Hit::min_distance && distance < hit.distance) {
+            hit.distance = distance;
+            hit.primitive = sphere;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool SphereSet::intersect(std::uint32_t sphere, const Ray& ray, Hit& hit) const {
+    float oc_x = ray.origin.x - center_x[sphere];
+    float oc_y = ray.origin.y - center_y[sphere];
+    float oc_z = ray.origin.z - center_z[sphere];
+
+    float b = oc_x * ray.direction.x + oc_y * ray.direction.y + oc_z * ray.direction.z;
+    float c = oc_x * oc_x + oc_y * oc_y + oc_z * oc_z - radius[sphere] * radius[sphere];
+    float discriminant = b * b - c;
+    if(!(discriminant >= 0.0f)) { return false; }
+
+    float root = std::sqrt(discriminant);
+    float distance = -b - root;
+    if(distance <= Hit::min_distance) { distance = root - b; }
+
+    if(distance > Hit::min_distance && distance < hit.distance) {
+        hit.distance = distance;
+        hit.primitive = sphere;
+        return true;
+    }
+
+    return false;
+}
+
+bool SphereSet::trace(const Ray& ray, Hit& hit) const {
+    return wide_bvh.intersect(ray, hit, [this](std::uint32_t sphere, const Ray& ray, Hit& hit) {
+        return intersect(sphere, ray, hit);
+    });
+}
+
+bool SphereSet::occluded(const Ray& ray, float max_distance) const {
+    return wide_bvh.occluded(ray, max_distance, [this](std::uint32_t sphere, const Ray& ray, Hit& hit) {
+        return intersect(sphere, ray, hit);
+    });
+}
+
+vec3 SphereSet::get_normal(const Ray& ray, const Hit& hit) const {
+    return (ray.at(hit.distance) - get_center(hit.primitive)) / radius[hit.primitive];
+}
+
+std::vector<AABB> SphereSet::get_all_bounds() const {
+    std::vector<AABB> bounds(count);
+    for(std::size_t sphere = 0 ; sphere < count ; ++sphere) {
+        bounds[sphere] = get_bounds(sphere);
+    }
+
+    return bounds;
+}
@@ -0,0 +1,445 @@
+/***************************************************************************************************
+ * @file  TriangleMesh.cpp
+ * @brief Implementation of the TriangleMesh class
+ **************************************************************************************************/
+
+#include "primitives/TriangleMesh.hpp"
+
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Profiler.hpp"
+#include "cache/CacheReader.hpp"
+#include "cache/CacheWriter.hpp"
+#include "maths/geometry.hpp"
+
+/* This file is compiled with -ffp-contract=off: the scalar and batched kernels must round every
+ * operation the same way, which fused multiply-adds would break */
+
+namespace {
+    /**
+     * @brief Möller–Trumbore ray-triangle intersection. The operations and their order match the
+     * AVX2 kernel of TriangleMesh::intersect exactly.
+     * @param origin The origin of the ray.
+     * @param direction The direction of the ray.
+     * @param vertex The first vertex of the triangle.
+     * @param edge1 The edge from the first to the second vertex.
+     * @param edge2 The edge from the first to the third vertex.
+     * @param distance The distance of the hit along the ray, if any.
+     * @return Whether the ray hits the triangle's plane inside the triangle.
+     */
+    bool intersect_triangle(const float origin[3], const float direction[3], const float vertex[3],
+                            const float edge1[3], const float edge2[3], float& distance) {
+        /* A degenerate triangle or a ray parallel to it gives an infinite or NaN inverse
+         * determinant, which fails the barycentric tests below */
+        float p_x = direction[1] * edge2[2] - direction[2] * edge2[1];
+        float p_y = direction[2] * edge2[0] - direction[0] * edge2[2];
+        float p_z = direction[0] * edge2[1] - direction[1] * edge2[0];
+        float inverse_determinant = 1.0f / (edge1[0] * p_x + edge1[1] * p_y + edge1[2] * p_z);
+
+        float t_x = origin[0] - vertex[0];
+        float t_y = origin[1] - vertex[1];
+        float t_z = origin[2] - vertex[2];
+        float u = (t_x * p_x + t_y * p_y + t_z * p_z) * inverse_determinant;
+        if(!(u >= 0.0f && u <= 1.0f)) { return false; }
+
+        float q_x = t_y * edge1[2] - t_z * edge1[1];
+        float q_y = t_z * edge1[0] - t_x * edge1[2];
+        float q_z = t_x * edge1[1] - t_y * edge1[0];
+        float v = (direction[0] * q_x + direction[1] * q_y + direction[2] * q_z) * inverse_determinant;
+        if(!(v >= 0.0f && u + v <= 1.0f)) { return false; }
+
+        distance = (edge2[0] * q_x + edge2[1] * q_y + edge2[2] * q_z) * inverse_determinant;
+        return true;
+    }
+
+    /**
+     * @brief Calls a function on chunks of a range of triangles, in parallel if there is a pool.
+     * @param pool The pool, nullptr to call the function on the whole range.
+     * @param count The number of triangles.
+     * @param function Called as function(begin, end) on the chunks.
+     */
+    template<typename Function>
+    void for_each_chunk(ThreadPool* pool, std::size_t count, const Function& function) {
+        if(pool == nullptr) { return function(0, count); }
+
+        ThreadPool::TaskGroup group(*pool);
+        std::size_t chunk_count = 4 * pool->size();
+        for(std::size_t chunk = 0 ; chunk < chunk_count ; ++chunk) {
+            group.submit([&function, count, chunk, chunk_count] {
+                function(count * chunk / chunk_count, count * (chunk + 1) / chunk_count);
+            });
+        }
+        group.wait();
+    }
+}
+
+TriangleMesh::TriangleMesh(std::vector<vec3> positions, std::vector<std::uint32_t> indices)
+    : positions(std::move(positions)), indices(std::move(indices)), triangle_count(this->indices.size() / 3) {
+    build_triangle_arrays(nullptr);
+}
+
+TriangleMesh::TriangleMesh(std::vector<vec3> positions, std::vector<std::uint32_t> indices, ThreadPool& pool)
+    : positions(std::move(positions)), indices(std::move(indices)), triangle_count(this->indices.size() / 3) {
+    build_triangle_arrays(&pool);
+}
+
+TriangleMesh::TriangleMesh(CacheReader& reader) {
+    reader.read_array(positions);
+    reader.read_array(indices);
+    triangle_count = indices.size() / 3;
+
+    if(indices.size() % 3 != 0) { throw std::runtime_error("Failed to read the indices of a cached mesh"); }
+    for(std::uint32_t index : indices) {
+        if(index >= positions.size()) { throw std::runtime_error("Failed to read the indices of a cached mesh, one is out of range"); }
+    }
+
+    for(AlignedVector<float>* array : { &vertex_x, &vertex_y, &vertex_z, &edge1_x, &edge1_y, &edge1_z,
+                                        &edge2_x, &edge2_y, &edge2_z }) {
+        reader.read_array(*array);
+        if(array->size() != (triangle_count + batch_size - 1) / batch_size * batch_size) {
+            throw std::runtime_error("Failed to read the triangle arrays of a cached mesh");
+        }
+    }
+
+    bvh = BVH(reader, triangle_count);
+    wide_bvh = WideBVH<wide_bvh_width>(reader, triangle_count);
+}
+
+void TriangleMesh::save(CacheWriter& writer) const {
+    writer.write_array(std::span<const vec3>(positions));
+    writer.write_array(std::span<const std::uint32_t>(indices));
+
+    for(const AlignedVector<float>* array : { &vertex_x, &vertex_y, &vertex_z, &edge1_x, &edge1_y, &edge1_z,
+                                              &edge2_x, &edge2_y, &edge2_z }) {
+        writer.write_array(std::span<const float>(*array));
+    }
+
+    bvh.save(writer);
+    wide_bvh.save(writer);
+}
+
+std::size_t TriangleMesh::get_triangle_count() const {
+    return triangle_count;
+}
+
+const std::vector<vec3>& TriangleMesh::get_positions() const {
+    return positions;
+}
+
+const std::vector<std::uint32_t>& TriangleMesh::get_indices() const {
+    return indices;
+}
+
+const vec3& TriangleMesh::get_vertex(std::size_t triangle, unsigned int vertex) const {
+    return positions[indices[3 * triangle + vertex]];
+}
+
+AABB TriangleMesh::get_bounds(std::size_t triangle) const {
+    AABB bounds;
+    bounds.grow(get_vertex(triangle, 0));
+    bounds.grow(get_vertex(triangle, 1));
+    bounds.grow(get_vertex(triangle, 2));
+
+    return bounds;
+}
+
+void TriangleMesh::build_bvh(BVH::Builder builder) {
+    bvh = BVH(get_all_bounds(nullptr), builder);
+    wide_bvh = WideBVH<wide_bvh_width>(bvh);
+}
+
+void TriangleMesh::build_bvh(ThreadPool& pool, BVH::Builder builder) {
+    bvh = BVH(get_all_bounds(&pool), pool, builder);
+    wide_bvh = WideBVH<wide_bvh_width>(bvh);
+}
+
+const BVH& TriangleMesh::get_bvh() const {
+    return bvh;
+}
+
+const WideBVH<wide_bvh_width>& TriangleMesh::get_wide_bvh() const {
+    return wide_bvh;
+}
+
+void TriangleMesh::set_material(std::uint32_t material) {
+    this->material = material;
+}
+
+std::uint32_t TriangleMesh::get_material() const {
+    return material;
+}
+
+bool TriangleMesh::set_positions(std::vector<vec3> positions) {
+    return update_positions(std::move(positions), nullptr);
+}
+
+bool TriangleMesh::set_positions(std::vector<vec3> positions, ThreadPool& pool) {
+    return update_positions(std::move(positions), &pool);
+}
+
+std::size_t TriangleMesh::get_memory_usage() const {
+    return positions.size() * sizeof(vec3) + indices.size() * sizeof(std::uint32_t)
+           + 9 * vertex_x.size() * sizeof(float)
+           + bvh.get_nodes().size() * sizeof(BVH::Node)
+           + wide_bvh.get_nodes().size() * sizeof(WideBVH<wide_bvh_width>::Node)
+           + wide_bvh.get_primitives().size() * sizeof(std::uint32_t);
+}
+
+bool TriangleMesh::intersect(const Ray& ray, Hit& hit) const {
+    PROFILE_COUNT(INTERSECTIONS_TESTED, triangle_count);
+
+#ifdef MATHS_SIMD_AVX2
+    const __m256 origin_x = _mm256_set1_ps(ray.origin.x);
+    const __m256 origin_y = _mm256_set1_ps(ray.origin.y);
+    const __m256 origin_z = _mm256_set1_ps(ray.origin.z);
+    const __m256 direction_x = _mm256_set1_ps(ray.direction.x);
+    const __m256 direction_y = _mm256_set1_ps(ray.direction.y);
+    const __m256 direction_z = _mm256_set1_ps(ray.direction.z);
+    const __m256 min_distance = _mm256_set1_ps(Hit::min_distance);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i step = _mm256_set1_epi32(batch_size);
+
+    __m256 closest = _mm256_set1_ps(hit.distance);
+    __m256i closest_triangle = _mm256_set1_epi32(-1);
+    __m256i triangle = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for(std::size_t first = 0 ; first < triangle_count ; first += batch_size) {
+        __m256 edge1_x = _mm256_load_ps(this->edge1_x.data() + first);
+        __m256 edge1_y = _mm256_load_ps(this->edge1_y.data() + first);
+        __m256 edge1_z = _mm256_load_ps(this->edge1_z.data() + first);
+        __m256 edge2_x = _mm256_load_ps(this->edge2_x.data() + first);
+        __m256 edge2_y = _mm256_load_ps(this->edge2_y.data() + first);
+        __m256 edge2_z = _mm256_load_ps(this->edge2_z.data() + first);
+
+        __m256 p_x = _mm256_sub_ps(_mm256_mul_ps(direction_y, edge2_z), _mm256_mul_ps(direction_z, edge2_y));
+        __m256 p_y = _mm256_sub_ps(_mm256_mul_ps(direction_z, edge2_x), _mm256_mul_ps(direction_x, edge2_z));
+        __m256 p_z = _mm256_sub_ps(_mm256_mul_ps(direction_x, edge2_y), _mm256_mul_ps(direction_y, edge2_x));
+        __m256 inverse_determinant = _mm256_div_ps(one, _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(edge1_x, p_x), _mm256_mul_ps(edge1_y, p_y)), _mm256_mul_ps(edge1_z, p_z)
+        ));
+
+        __m256 t_x = _mm256_sub_ps(origin_x, _mm256_load_ps(vertex_x.data() + first));
+        __m256 t_y = _mm256_sub_ps(origin_y, _mm256_load_ps(vertex_y.data() + first));
+        __m256 t_z = _mm256_sub_ps(origin_z, _mm256_load_ps(vertex_z.data() + first));
+        __m256 u = _mm256_mul_ps(_mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(t_x, p_x), _mm256_mul_ps(t_y, p_y)), _mm256_mul_ps(t_z, p_z)
+        ), inverse_determinant);
+
+        __m256 q_x = _mm256_sub_ps(_mm256_mul_ps(t_y, edge1_z), _mm256_mul_ps(t_z, edge1_y));
+        __m256 q_y = _mm256_sub_ps(_mm256_mul_ps(t_z, edge1_x), _mm256_mul_ps(t_x, edge1_z));
+        __m256 q_z = _mm256_sub_ps(_mm256_mul_ps(t_x, edge1_y), _mm256_mul_ps(t_y, edge1_x));
+        __m256 v = _mm256_mul_ps(_mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(direction_x, q_x), _mm256_mul_ps(direction_y, q_y)), _mm256_mul_ps(direction_z, q_z)
+        ), inverse_determinant);
+        __m256 distance = _mm256_mul_ps(_mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(edge2_x, q_x), _mm256_mul_ps(edge2_y, q_y)), _mm256_mul_ps(edge2_z, q_z)
+        ), inverse_determinant);
+
+        __m256 mask = _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(distance, min_distance, _CMP_GT_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(distance, closest, _CMP_LT_OQ));
+
+        closest = _mm256_blendv_ps(closest, distance, mask);
+        closest_triangle = _mm256_castps_si256(_mm256_blendv_ps(
+            _mm256_castsi256_ps(closest_triangle), _mm256_castsi256_ps(triangle), mask
+        ));
+        triangle = _mm256_add_epi32(triangle, step);
+    }
+
+    alignas(32) float distances[batch_size];
+    alignas(32) int triangles[batch_size];
+    _mm256_store_ps(distances, closest);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(triangles), closest_triangle);
+#else
+    /* The lanes of the AVX2 kernel, with the arithmetic of the scalar one and without branches so
+     * that the compiler vectorises them */
+    alignas(32) float distances[batch_size];
+    alignas(32) int triangles[batch_size];
+    for(std::size_t lane = 0 ; lane < batch_size ; ++lane) {
+        distances[lane] = hit.distance;
+        triangles[lane] = -1;
+    }
+
+    for(std::size_t first = 0 ; first < triangle_count ; first += batch_size) {
+        for(std::size_t lane = 0 ; lane < batch_size ; ++lane) {
+            const std::size_t triangle = first + lane;
+
+            float p_x = ray.direction.y * edge2_z[triangle] - ray.direction.z * edge2_y[triangle];
+            float p_y = ray.direction.z * edge2_x[triangle] - ray.direction.x * edge2_z[triangle];
+            float p_z = ray.direction.x * edge2_y[triangle] - ray.direction.y * edge2_x[triangle];
+            float inverse_determinant = 1.0f / (edge1_x[triangle] * p_x + edge1_y[triangle] * p_y + edge1_z[triangle] * p_z);
+
+            float t_x = ray.origin.x - vertex_x[triangle];
+            float t_y = ray.origin.y - vertex_y[triangle];
+            float t_z = ray.origin.z - vertex_z[triangle];
+            float u = (t_x * p_x + t_y * p_y + t_z * p_z) * inverse_determinant;
+
+            float q_x = t_y * edge1_z[triangle] - t_z * edge1_y[triangle];
+            float q_y = t_z * edge1_x[triangle] - t_x * edge1_z[triangle];
+            float q_z = t_x * edge1_y[triangle] - t_y * edge1_x[triangle];
+            float v = (ray.direction.x * q_x + ray.direction.y * q_y + ray.direction.z * q_z) * inverse_determinant;
+            float distance = (edge2_x[triangle] * q_x + edge2_y[triangle] * q_y + edge2_z[triangle] * q_z) * inverse_determinant;
+
+            bool is_closer = (u >= 0.0f) & (u <= 1.0f) & (v >= 0.0f) & (u + v <= 1.0f)
+                             & (distance > Hit::min_distance) & (distance < distances[lane]);
+            distances[lane] = is_closer ? distance : distances[lane];
+            triangles[lane] = is_closer ? static_cast<int>(triangle) : triangles[lane];
+        }
+    }
+#endif
+
+    /* Closest lane, the lowest index wins ties like in the scalar kernel */
+    bool found = false;
+    for(std::size_t lane = 0 ; lane < batch_size ; ++lane) {
+        if(triangles[lane] < 0) { continue; }
+
+        bool closer = distances[lane] < hit.distance;
+        bool tie = found && distances[lane] == hit.distance && triangles[lane] < static_cast<int>(hit.primitive);
+        if(closer || tie) {
+            hit.distance = distances[lane];
+            hit.primitive = triangles[lane];
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool TriangleMesh::intersect_reference(const Ray& ray, Hit& hit) const {
+    const float origin[3]{ ray.origin.x, ray.origin.y, ray.origin.z };
+    const float direction[3]{ ray.direction.x, ray.direction.y, ray.direction.z };
+    bool found = false;
+
+    for(std::size_t triangle = 0 ; triangle < triangle_count ; ++triangle) {
+        const vec3& vertex0 = get_vertex(triangle, 0);
+        const vec3& vertex1 = get_vertex(triangle, 1);
+        const vec3& vertex2 = get_vertex(triangle, 2);
+
+        const float vertex[3]{ vertex0.x, vertex0.y, vertex0.z };
+        const float edge1[3]{ vertex1.x - vertex0.x, vertex1.y - vertex0.y, vertex1.z - vertex0.z };
+        const float edge2[3]{ vertex2.x - vertex0.x, vertex2.y - vertex0.y, vertex2.z - vertex0.z };
+
+        float distance;
+        if(intersect_triangle(origin, direction, vertex, edge1, edge2, distance)
+           && distance > Hit::min_distance && distance < hit.distance) {
+            hit.distance = distance;
+            hit.primitive = triangle;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool TriangleMesh::intersect(std::uint32_t triangle, const Ray& ray, Hit& hit) const {
+    const float origin[3]{ ray.origin.x, ray.origin.y, ray.origin.z };
+    const float direction[3]{ ray.direction.x, ray.direction.y, ray.direction.z };
+    const float vertex[3]{ vertex_x[triangle], vertex_y[triangle], vertex_z[triangle] };
+    const float edge1[3]{ edge1_x[triangle], edge1_y[triangle], edge1_z[triangle] };
+    const float edge2[3]{ edge2_x[triangle], edge2_y[triangle], edge2_z[triangle] };
+
+    float distance;
+    if(intersect_triangle(origin, direction, vertex, edge1, edge2, distance)
+       && distance > Hit::min_distance && distance < hit.distance) {
+        hit.distance = distance;
+        hit.primitive = triangle;
+        return true;
+    }
+
+    return false;
+}
+
+bool TriangleMesh::trace(const Ray& ray, Hit& hit) const {
+    return wide_bvh.intersect(ray, hit, [this](std::uint32_t triangle, const Ray& ray, Hit& hit) {
+        return intersect(triangle, ray, hit);
+    });
+}
+
+bool TriangleMesh::occluded(const Ray& ray, float max_distance) const {
+    return wide_bvh.occluded(ray, max_distance, [this](std::uint32_t triangle, const Ray& ray, Hit& hit) {
+        return intersect(triangle, ray, hit);
+    });
+}
+
+vec3 TriangleMesh::get_normal(const Ray& ray, const Hit& hit) const {
+    const vec3& vertex0 = get_vertex(hit.primitive, 0);
+    vec3 normal = normalize(cross(get_vertex(hit.primitive, 1) - vertex0, get_vertex(hit.primitive, 2) - vertex0));
+
+    return dot(normal, ray.direction) > 0.0f ? -normal : normal;
+}
+
+bool TriangleMesh::update_positions(std::vector<vec3> positions, ThreadPool* pool) {
+    /* The indices and the BVHs refer to the current vertices */
+    if(positions.size() != this->positions.size()) {
+        throw std::invalid_argument("Failed to move the vertices of a mesh, " + std::to_string(positions.size())
+                                    + " positions were given for " + std::to_string(this->positions.size()) + " vertices");
+    }
+
+    this->positions = std::move(positions);
+    build_triangle_arrays(pool);
+
+    if(bvh.get_nodes().empty()) { return false; }
+
+    /* The wide BVH is refitted along with the binary one, or collapsed again if it was rebuilt */
+    std::vector<AABB> bounds = get_all_bounds(pool);
+    bool rebuilt = pool != nullptr ? bvh.refit(bounds, *pool) : bvh.refit(bounds);
+
+    if(rebuilt) {
+        wide_bvh = WideBVH<wide_bvh_width>(bvh);
+    } else if(pool != nullptr) {
+        wide_bvh.refit(bounds, *pool);
+    } else {
+        wide_bvh.refit(bounds);
+    }
+
+    return rebuilt;
+}
+
+std::vector<AABB> TriangleMesh::get_all_bounds(ThreadPool* pool) const {
+    std::vector<AABB> bounds(triangle_count);
+    for_each_chunk(pool, triangle_count, [&](std::size_t begin, std::size_t end) {
+        for(std::size_t triangle = begin ; triangle < end ; ++triangle) {
+            bounds[triangle] = get_bounds(triangle);
+        }
+    });
+
+    return bounds;
+}
+
+void TriangleMesh::build_triangle_arrays(ThreadPool* pool) {
+    /* The padding triangles are degenerate so that they are never hit */
+    std::size_t padded_count = (triangle_count + batch_size - 1) / batch_size * batch_size;
+
+    for(AlignedVector<float>* array : { &vertex_x, &vertex_y, &vertex_z, &edge1_x, &edge1_y, &edge1_z,
+                                        &edge2_x, &edge2_y, &edge2_z }) {
+        array->resize(padded_count, 0.0f);
+    }
+
+    for_each_chunk(pool, triangle_count, [&](std::size_t begin, std::size_t end) {
+        for(std::size_t triangle = begin ; triangle < end ; ++triangle) {
+            fill_triangle(triangle);
+        }
+    });
+}
+
+void TriangleMesh::fill_triangle(std::size_t triangle) {
+    const vec3& vertex0 = get_vertex(triangle, 0);
+    const vec3& vertex1 = get_vertex(triangle, 1);
+    const vec3& vertex2 = get_vertex(triangle, 2);
+
+    vertex_x[triangle] = vertex0.x;
+    vertex_y[triangle] = vertex0.y;
+    vertex_z[triangle] = vertex0.z;
+    edge1_x[triangle] = vertex1.x - vertex0.x;
+    edge1_y[triangle] = vertex1.y - vertex0.y;
+    edge1_z[triangle] = vertex1.z - vertex0.z;
+    edge2_x[triangle] = vertex2.x - vertex0.x;
+    edge2_y[triangle] = vertex2.y - vertex0.y;
+    edge2_z[triangle] = vertex2.z - vertex0.z;
+}